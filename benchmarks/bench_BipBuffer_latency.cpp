@@ -0,0 +1,206 @@
+// Round-trip latency benchmark. A ping side sends timestamped messages through
+// one bip buffer and a pong side echoes them back through a second one, either
+// between two threads or between two processes over SharedMemory. Reports the
+// round-trip time distribution per wait strategy as JSON:
+//
+//   benchmark_latency [--quick] [--iterations N] [--warmup N] [--message-size N]
+//     [--waits yield,spin,pause,futex] [--modes threads,processes]
+//     [--placements none,same-core,...] [--output results.json]
+
+#include "SharedMemory.hpp"
+#include "bench_common.hpp"
+#include "bench_pingpong.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = 64 * 1024;
+constexpr size_t STRIDE = sizeof(mvi::BipBufferHeaderV2) + BUFFER_SIZE;
+constexpr size_t MEMORY_SIZE = 2 * STRIDE; // Ping buffer, then pong buffer
+constexpr const char* SHM_NAME = "benchlatency";
+
+struct Config {
+  bool processes; // Pong side in a forked process instead of a thread
+  bench::Placement placement;
+  bench::PingPongConfig pingPong;
+};
+
+mvi::BipBufferHeaderV2& PingBuffer(uint8_t* memory) {
+  return *reinterpret_cast<mvi::BipBufferHeaderV2*>(memory);
+}
+
+mvi::BipBufferHeaderV2& PongBuffer(uint8_t* memory) {
+  return *reinterpret_cast<mvi::BipBufferHeaderV2*>(memory + STRIDE);
+}
+
+void CreateBuffers(uint8_t* memory, bench::Wait wait) {
+  mvi::BipBufferHeaderV2::Create(memory, STRIDE, bench::WaitFlags(wait));
+  mvi::BipBufferHeaderV2::Create(memory + STRIDE, STRIDE, bench::WaitFlags(wait));
+}
+
+std::optional<bench::LatencyHistogram> RunThreads(const bench::PingPongConfig& config) {
+  const bench::AlignedBuffer memory = bench::AllocateAligned(MEMORY_SIZE, mvi::CACHE_LINE_SIZE);
+  uint8_t* data = memory.get();
+  CreateBuffers(data, config.wait);
+
+  bool ponged = false;
+  std::thread pong([&] { ponged = bench::Pong(PingBuffer(data), PongBuffer(data), config); });
+  auto histogram = bench::Ping(PingBuffer(data), PongBuffer(data), config);
+  pong.join();
+  if (!ponged) { return std::nullopt; }
+  return histogram;
+}
+
+#ifndef _WIN32
+std::optional<bench::LatencyHistogram> RunProcesses(const bench::PingPongConfig& config) {
+  (void)mvi::SharedMemory::Destroy(SHM_NAME);
+  mvi::SharedMemory shm(SHM_NAME, MEMORY_SIZE);
+  mvi::SharedMemory::Options options;
+  options.prefault = true;
+  if (auto err = shm.open(mvi::SharedMemory::Access::ReadWrite, options)) {
+    std::cerr << "can not create shared memory: " << err->what() << "\n";
+    return std::nullopt;
+  }
+  CreateBuffers(shm.as<uint8_t>(), config.wait);
+
+  const pid_t pid = bench::ForkChild([&] {
+    // Map the area anew by name, as an unrelated consumer process would
+    mvi::SharedMemory child(SHM_NAME, 0);
+    if (child.open(mvi::SharedMemory::Access::ReadWrite, options)) { return false; }
+    auto* data = child.as<uint8_t>();
+    return bench::Pong(PingBuffer(data), PongBuffer(data), config);
+  });
+  std::optional<bench::LatencyHistogram> histogram;
+  if (pid > 0) {
+    auto* data = shm.as<uint8_t>();
+    histogram = bench::Ping(PingBuffer(data), PongBuffer(data), config);
+  }
+  if (!bench::JoinChild(pid)) { histogram.reset(); }
+  (void)shm.close();
+  (void)mvi::SharedMemory::Destroy(SHM_NAME);
+  return histogram;
+}
+#endif
+
+void Report(bench::JsonWriter& json, const Config& config, const bench::LatencyHistogram& rtt) {
+  json.begin();
+  json.field("mode", config.processes ? "processes" : "threads");
+  json.field("wait", bench::WaitName(config.pingPong.wait));
+  json.field("message_size", uint64_t(config.pingPong.messageSize));
+  json.field("placement", bench::PlacementName(config.placement));
+  json.field("ping_cpu", config.pingPong.pingCpu);
+  json.field("pong_cpu", config.pingPong.pongCpu);
+  json.field("round_trips", rtt.count());
+  json.field("min_ns", rtt.min());
+  json.field("mean_ns", rtt.mean());
+  json.field("p50_ns", rtt.percentile(50));
+  json.field("p99_ns", rtt.percentile(99));
+  json.field("p999_ns", rtt.percentile(99.9));
+  json.field("max_ns", rtt.max());
+  json.end();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> waits{"yield", "spin", "pause", "futex"};
+  std::vector<std::string> modes{"threads", "processes"};
+  std::vector<std::string> placements{"none", "same-core", "same-socket", "cross-socket"};
+  uint64_t iterations = 100000;
+  uint64_t warmup = 10000;
+  size_t messageSize = 64;
+  std::string output;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--quick") {
+      iterations = 200;
+      warmup = 20;
+      placements = {"none"};
+    } else if (arg == "--iterations" && hasValue) {
+      iterations = bench::ParseSize(argv[++i]);
+    } else if (arg == "--warmup" && hasValue) {
+      warmup = bench::ParseSize(argv[++i]);
+    } else if (arg == "--message-size" && hasValue) {
+      messageSize = size_t(bench::ParseSize(argv[++i]));
+    } else if (arg == "--waits" && hasValue) {
+      waits = bench::SplitList(argv[++i]);
+    } else if (arg == "--modes" && hasValue) {
+      modes = bench::SplitList(argv[++i]);
+    } else if (arg == "--placements" && hasValue) {
+      placements = bench::SplitList(argv[++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--quick] [--iterations N] [--warmup N] [--message-size N]"
+                   " [--waits yield,spin,pause,futex] [--modes threads,processes]"
+                   " [--placements none,same-core,same-socket,cross-socket] [--output file]\n";
+      return 2;
+    }
+  }
+  if (messageSize < sizeof(bench::PingMessage) || messageSize > BUFFER_SIZE / 2) {
+    std::cerr << "message size must be between " << sizeof(bench::PingMessage) << " and "
+              << BUFFER_SIZE / 2 << "\n";
+    return 2;
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) {
+      std::cerr << "can not write " << output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  const std::vector<bench::Cpu> topology = bench::ReadTopology();
+  bench::JsonWriter json(out, "bipbuffer-latency");
+  int status = 0;
+  for (const std::string& placementName : placements) {
+    const bench::Placement placement = bench::ParsePlacement(placementName);
+    const auto cpus = bench::FindCpuPair(topology, placement);
+    if (!cpus) {
+      std::cerr << "skipping placement " << placementName << ": no such CPU pair\n";
+      continue;
+    }
+
+    for (const std::string& mode : modes) {
+      for (const std::string& waitName : waits) {
+        const Config config{mode == "processes",
+          placement,
+          {bench::ParseWait(waitName),
+            messageSize,
+            cpus->first,
+            cpus->second,
+            iterations,
+            warmup}};
+#ifdef _WIN32
+        if (config.processes) {
+          std::cerr << "skipping processes: fork is not available\n";
+          continue;
+        }
+        const auto rtt = RunThreads(config.pingPong);
+#else
+        const auto rtt =
+          config.processes ? RunProcesses(config.pingPong) : RunThreads(config.pingPong);
+#endif
+        if (!rtt) {
+          std::cerr << mode << " " << waitName << ": the other side timed out\n";
+          status = 1;
+          continue;
+        }
+        Report(json, config, *rtt);
+      }
+    }
+  }
+  return status;
+}
@@ -0,0 +1,157 @@
+// Throughput benchmark sweeping buffer sizes, message size distributions,
+// copying and thread placement. Prints one JSON result per configuration so
+// runs can be compared over time:
+//
+//   benchmark_matrix [--quick] [--duration-ms N] [--buffer-sizes 4K,1M,1G]
+//     [--messages fixed:64,uniform:1-4096] [--placements none,same-core,...]
+//     [--output results.json]
+
+#include "bench_common.hpp"
+#include "bench_throughput.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Config {
+  bench::ThroughputConfig throughput;
+  bench::Placement placement;
+};
+
+std::optional<bench::ThroughputResult> Run(const bench::ThroughputConfig& config) {
+  const size_t total = sizeof(mvi::BipBufferHeaderV2) + config.bufferSize;
+  const bench::AlignedBuffer memory = bench::AllocateAligned(total, mvi::CACHE_LINE_SIZE);
+  auto* layout = mvi::BipBufferHeaderV2::Create(memory.get(), total);
+
+  bench::ThroughputControl control;
+  bool consumed = false;
+  std::thread reader([&] { consumed = bench::Consume(*layout, control, config); });
+  std::optional<bench::ThroughputResult> result;
+  std::thread writer([&] { result = bench::Produce(*layout, control, config); });
+  writer.join();
+  reader.join();
+  if (!result || !consumed) { return std::nullopt; }
+  result->seconds = control.seconds();
+  return result;
+}
+
+void Report(
+  bench::JsonWriter& json, const Config& config, const bench::ThroughputResult& result) {
+  json.begin();
+  json.field("buffer_size", uint64_t(config.throughput.bufferSize));
+  json.field("message_sizes", config.throughput.messages.name());
+  json.field("copy", config.throughput.copy);
+  json.field("placement", bench::PlacementName(config.placement));
+  json.field("writer_cpu", config.throughput.writerCpu);
+  json.field("reader_cpu", config.throughput.readerCpu);
+  json.field("seconds", result.seconds);
+  json.field("messages", result.messages);
+  json.field("bytes", result.bytes);
+  json.field("msgs_per_sec", result.messagesPerSecond());
+  json.field("gb_per_sec", result.gigabytesPerSecond());
+  json.field("wasted_tail_pct", result.wastedPercent());
+  json.field("reserve_failures", result.reserveFailures);
+  json.end();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> bufferSizes{"4K", "64K", "1M", "16M", "256M", "1G"};
+  std::vector<std::string> messageSizes{"fixed:16",
+    "fixed:64",
+    "fixed:1K",
+    "fixed:16K",
+    "uniform:1-128",
+    "uniform:1-4K"};
+  std::vector<std::string> placements{"none", "same-core", "same-socket", "cross-socket"};
+  std::vector<bool> copies{false, true};
+  uint64_t durationMs = 250;
+  std::string output;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--quick") {
+      bufferSizes = {"4K", "64K"};
+      messageSizes = {"fixed:64", "uniform:1-256"};
+      placements = {"none"};
+      durationMs = 10;
+    } else if (arg == "--duration-ms" && hasValue) {
+      durationMs = bench::ParseSize(argv[++i]);
+    } else if (arg == "--buffer-sizes" && hasValue) {
+      bufferSizes = bench::SplitList(argv[++i]);
+    } else if (arg == "--messages" && hasValue) {
+      messageSizes = bench::SplitList(argv[++i]);
+    } else if (arg == "--placements" && hasValue) {
+      placements = bench::SplitList(argv[++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--quick] [--duration-ms N] [--buffer-sizes 4K,1M,...]"
+                   " [--messages fixed:N,uniform:A-B,...] [--placements none,same-core,"
+                   "same-socket,cross-socket] [--output file]\n";
+      return 2;
+    }
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) {
+      std::cerr << "can not write " << output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  const std::vector<bench::Cpu> topology = bench::ReadTopology();
+  bench::JsonWriter json(out, "bipbuffer-throughput");
+  int status = 0;
+  for (const std::string& placementName : placements) {
+    const bench::Placement placement = bench::ParsePlacement(placementName);
+    const auto cpus = bench::FindCpuPair(topology, placement);
+    if (!cpus) {
+      std::cerr << "skipping placement " << placementName << ": no such CPU pair\n";
+      continue;
+    }
+
+    for (const std::string& bufferSizeText : bufferSizes) {
+      const auto bufferSize = size_t(bench::ParseSize(bufferSizeText));
+      for (const std::string& messageText : messageSizes) {
+        bench::MessageSizes messages{};
+        if (bufferSize == 0 || !bench::MessageSizes::Parse(messageText, messages)) {
+          std::cerr << "invalid configuration " << bufferSizeText << " " << messageText << "\n";
+          return 2;
+        }
+        // Messages must leave room for others, or every reservation waits for the reader
+        if (messages.max > bufferSize / 4) { continue; }
+
+        for (const bool copy : copies) {
+          const Config config{
+            {bufferSize, messages, copy, cpus->first, cpus->second, durationMs * 1000000},
+            placement};
+          try {
+            const auto result = Run(config.throughput);
+            if (!result) {
+              std::cerr << "run " << bufferSizeText << " " << messageText << " failed\n";
+              status = 1;
+              continue;
+            }
+            Report(json, config, *result);
+          } catch (const std::bad_alloc&) {
+            std::cerr << "skipping buffer size " << bufferSizeText << ": out of memory\n";
+          }
+        }
+      }
+    }
+  }
+  return status;
+}
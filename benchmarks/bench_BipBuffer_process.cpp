@@ -0,0 +1,335 @@
+// Cross-process benchmark. Runs the throughput and the round-trip latency
+// benchmarks once between two threads and once between two processes, where
+// a forked consumer maps a named SharedMemory segment by name, and reports both
+// side by side so the cost of the shared memory path (page faults, TLB misses,
+// NUMA placement) shows up:
+//
+//   benchmark_process [--quick] [--duration-ms N] [--buffer-sizes 64K,1M,...]
+//     [--messages fixed:64,uniform:1-1K] [--placements none,same-core,...]
+//     [--wait yield|spin|pause|futex] [--iterations N] [--prefault] [--huge-pages]
+//     [--output results.json]
+
+#include "SharedMemory.hpp"
+#include "bench_common.hpp"
+#include "bench_pingpong.hpp"
+#include "bench_throughput.hpp"
+
+#include <algorithm> // for max
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char* SHM_NAME = "benchprocess";
+
+struct Config {
+  bench::Placement placement;
+  bench::ThroughputConfig throughput;
+  bench::PingPongConfig pingPong;
+  mvi::SharedMemory::Options options;
+};
+
+struct Results {
+  std::optional<bench::ThroughputResult> throughput;
+  std::optional<bench::LatencyHistogram> latency;
+};
+
+/// Size of one bip buffer of the ping-pong, including its header
+size_t PingPongStride(const Config& config) {
+  return sizeof(mvi::BipBufferHeaderV2) + config.throughput.bufferSize;
+}
+
+/// Memory of a throughput run: the control block followed by the buffer
+size_t ThroughputSize(const Config& config) {
+  return sizeof(bench::ThroughputControl) + sizeof(mvi::BipBufferHeaderV2) +
+    config.throughput.bufferSize;
+}
+
+mvi::BipBufferHeaderV2& ThroughputBuffer(uint8_t* memory) {
+  return *reinterpret_cast<mvi::BipBufferHeaderV2*>(memory + sizeof(bench::ThroughputControl));
+}
+
+bench::ThroughputControl& Control(uint8_t* memory) {
+  return *reinterpret_cast<bench::ThroughputControl*>(memory);
+}
+
+Results RunThreads(const Config& config) {
+  Results results;
+  {
+    const size_t size = ThroughputSize(config);
+    const bench::AlignedBuffer memory = bench::AllocateAligned(size, mvi::CACHE_LINE_SIZE);
+    auto& control = *new (memory.get()) bench::ThroughputControl();
+    auto& layout = *mvi::BipBufferHeaderV2::Create(
+      memory.get() + sizeof(bench::ThroughputControl), size - sizeof(bench::ThroughputControl));
+    bool consumed = false;
+    std::thread reader([&] { consumed = bench::Consume(layout, control, config.throughput); });
+    std::thread writer(
+      [&] { results.throughput = bench::Produce(layout, control, config.throughput); });
+    writer.join();
+    reader.join();
+    if (!consumed) { results.throughput.reset(); }
+    if (results.throughput) { results.throughput->seconds = control.seconds(); }
+  }
+  {
+    const size_t stride = PingPongStride(config);
+    const bench::AlignedBuffer memory = bench::AllocateAligned(2 * stride, mvi::CACHE_LINE_SIZE);
+    const uint32_t flags = bench::WaitFlags(config.pingPong.wait);
+    auto& ping = *mvi::BipBufferHeaderV2::Create(memory.get(), stride, flags);
+    auto& pong = *mvi::BipBufferHeaderV2::Create(memory.get() + stride, stride, flags);
+    bool ponged = false;
+    std::thread ponger([&] { ponged = bench::Pong(ping, pong, config.pingPong); });
+    std::thread pinger([&] { results.latency = bench::Ping(ping, pong, config.pingPong); });
+    pinger.join();
+    ponger.join();
+    if (!ponged) { results.latency.reset(); }
+  }
+  return results;
+}
+
+#ifndef _WIN32
+/**
+ * Creates the named segment and lets `setup` initialize it, then runs `child`
+ * in a forked process that maps the segment again by name, as an unrelated
+ * consumer process would, while the parent runs `parent` on a new thread, so
+ * its CPU pinning does not outlive the run. Returns false if the segment could
+ * not be created or either side failed.
+ */
+template<typename Setup, typename Parent, typename Child>
+bool RunAcrossProcesses(size_t size,
+  const mvi::SharedMemory::Options& options,
+  Setup setup,
+  Parent parent,
+  Child child) {
+  (void)mvi::SharedMemory::Destroy(SHM_NAME);
+  mvi::SharedMemory shm(SHM_NAME, size);
+  if (auto err = shm.open(mvi::SharedMemory::Access::ReadWrite, options)) {
+    std::cerr << "can not create shared memory: " << err->what() << "\n";
+    return false;
+  }
+  setup(shm.as<uint8_t>());
+
+  const pid_t pid = bench::ForkChild([&] {
+    mvi::SharedMemory mapping(SHM_NAME, 0);
+    if (mapping.open(mvi::SharedMemory::Access::ReadWrite, options)) { return false; }
+    return child(mapping.as<uint8_t>());
+  });
+  bool parentSucceeded = false;
+  if (pid > 0) {
+    std::thread thread([&] { parentSucceeded = parent(shm.as<uint8_t>()); });
+    thread.join();
+  }
+  const bool childSucceeded = bench::JoinChild(pid);
+  (void)shm.close();
+  (void)mvi::SharedMemory::Destroy(SHM_NAME);
+  return parentSucceeded && childSucceeded;
+}
+
+Results RunProcesses(const Config& config) {
+  Results results;
+  const size_t size = ThroughputSize(config);
+  const bool streamed = RunAcrossProcesses(
+    size,
+    config.options,
+    [&](uint8_t* memory) {
+      new (memory) bench::ThroughputControl();
+      mvi::BipBufferHeaderV2::Create(
+        memory + sizeof(bench::ThroughputControl), size - sizeof(bench::ThroughputControl));
+    },
+    [&](uint8_t* memory) {
+      results.throughput =
+        bench::Produce(ThroughputBuffer(memory), Control(memory), config.throughput);
+      if (!results.throughput) { return false; }
+      // The consumer may still be draining, its end time is final once it has
+      const uint64_t deadline = bench::NowNs() + bench::PEER_TIMEOUT_NS;
+      while (Control(memory).endNs.load() == 0) {
+        if (bench::NowNs() >= deadline) { return false; }
+        std::this_thread::yield();
+      }
+      results.throughput->seconds = Control(memory).seconds();
+      return true;
+    },
+    [&](uint8_t* memory) {
+      return bench::Consume(ThroughputBuffer(memory), Control(memory), config.throughput);
+    });
+  if (!streamed) { results.throughput.reset(); }
+
+  const size_t stride = PingPongStride(config);
+  const uint32_t flags = bench::WaitFlags(config.pingPong.wait);
+  auto ping = [](uint8_t* memory) -> mvi::BipBufferHeaderV2& {
+    return *reinterpret_cast<mvi::BipBufferHeaderV2*>(memory);
+  };
+  auto pong = [stride](uint8_t* memory) -> mvi::BipBufferHeaderV2& {
+    return *reinterpret_cast<mvi::BipBufferHeaderV2*>(memory + stride);
+  };
+  const bool bounced = RunAcrossProcesses(
+    2 * stride,
+    config.options,
+    [&](uint8_t* memory) {
+      mvi::BipBufferHeaderV2::Create(memory, stride, flags);
+      mvi::BipBufferHeaderV2::Create(memory + stride, stride, flags);
+    },
+    [&](uint8_t* memory) {
+      results.latency = bench::Ping(ping(memory), pong(memory), config.pingPong);
+      return results.latency.has_value();
+    },
+    [&](uint8_t* memory) { return bench::Pong(ping(memory), pong(memory), config.pingPong); });
+  if (!bounced) { results.latency.reset(); }
+  return results;
+}
+#endif
+
+void Report(bench::JsonWriter& json,
+  const Config& config,
+  const Results& threads,
+  const Results& processes) {
+  json.begin();
+  json.field("buffer_size", uint64_t(config.throughput.bufferSize));
+  json.field("message_sizes", config.throughput.messages.name());
+  json.field("copy", config.throughput.copy);
+  json.field("placement", bench::PlacementName(config.placement));
+  json.field("writer_cpu", config.throughput.writerCpu);
+  json.field("reader_cpu", config.throughput.readerCpu);
+  json.field("prefault", config.options.prefault);
+  json.field("huge_pages", config.options.hugePages);
+  for (const auto& [mode, results] : {std::make_pair("threads", &threads),
+         std::make_pair("processes", &processes)}) {
+    const std::string prefix = mode;
+    if (results->throughput) {
+      json.field((prefix + "_msgs_per_sec").c_str(), results->throughput->messagesPerSecond());
+      json.field((prefix + "_gb_per_sec").c_str(), results->throughput->gigabytesPerSecond());
+    }
+  }
+  json.field("wait", bench::WaitName(config.pingPong.wait));
+  json.field("ping_message_size", uint64_t(config.pingPong.messageSize));
+  for (const auto& [mode, results] : {std::make_pair("threads", &threads),
+         std::make_pair("processes", &processes)}) {
+    const std::string prefix = mode;
+    if (results->latency) {
+      json.field((prefix + "_p50_ns").c_str(), results->latency->percentile(50));
+      json.field((prefix + "_p99_ns").c_str(), results->latency->percentile(99));
+      json.field((prefix + "_p999_ns").c_str(), results->latency->percentile(99.9));
+      json.field((prefix + "_max_ns").c_str(), results->latency->max());
+    }
+  }
+  json.end();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> bufferSizes{"64K", "1M", "16M", "256M"};
+  std::vector<std::string> messageSizes{"fixed:64", "fixed:4K", "uniform:1-1K"};
+  std::vector<std::string> placements{"none", "same-core", "same-socket", "cross-socket"};
+  uint64_t durationMs = 250;
+  uint64_t iterations = 100000;
+  std::string wait = "pause";
+  mvi::SharedMemory::Options options;
+  std::string output;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--quick") {
+      // Yielding also finishes quickly when both sides share a single CPU
+      bufferSizes = {"64K", "1M"};
+      messageSizes = {"fixed:64"};
+      placements = {"none"};
+      durationMs = 10;
+      iterations = 200;
+      wait = "yield";
+    } else if (arg == "--duration-ms" && hasValue) {
+      durationMs = bench::ParseSize(argv[++i]);
+    } else if (arg == "--buffer-sizes" && hasValue) {
+      bufferSizes = bench::SplitList(argv[++i]);
+    } else if (arg == "--messages" && hasValue) {
+      messageSizes = bench::SplitList(argv[++i]);
+    } else if (arg == "--placements" && hasValue) {
+      placements = bench::SplitList(argv[++i]);
+    } else if (arg == "--wait" && hasValue) {
+      wait = argv[++i];
+    } else if (arg == "--iterations" && hasValue) {
+      iterations = bench::ParseSize(argv[++i]);
+    } else if (arg == "--prefault") {
+      options.prefault = true;
+    } else if (arg == "--huge-pages") {
+      options.hugePages = true;
+    } else if (arg == "--output" && hasValue) {
+      output = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--quick] [--duration-ms N] [--buffer-sizes 64K,1M,...]"
+                   " [--messages fixed:N,uniform:A-B,...] [--placements none,same-core,"
+                   "same-socket,cross-socket] [--wait yield|spin|pause|futex] [--iterations N]"
+                   " [--prefault] [--huge-pages] [--output file]\n";
+      return 2;
+    }
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) {
+      std::cerr << "can not write " << output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  const std::vector<bench::Cpu> topology = bench::ReadTopology();
+  bench::JsonWriter json(out, "bipbuffer-process");
+  int status = 0;
+  for (const std::string& placementName : placements) {
+    const bench::Placement placement = bench::ParsePlacement(placementName);
+    const auto cpus = bench::FindCpuPair(topology, placement);
+    if (!cpus) {
+      std::cerr << "skipping placement " << placementName << ": no such CPU pair\n";
+      continue;
+    }
+
+    for (const std::string& bufferSizeText : bufferSizes) {
+      const auto bufferSize = size_t(bench::ParseSize(bufferSizeText));
+      for (const std::string& messageText : messageSizes) {
+        bench::MessageSizes messages{};
+        if (bufferSize == 0 || !bench::MessageSizes::Parse(messageText, messages)) {
+          std::cerr << "invalid configuration " << bufferSizeText << " " << messageText << "\n";
+          return 2;
+        }
+        // Messages must leave room for others, or every reservation waits for the reader
+        if (messages.max > bufferSize / 4) { continue; }
+
+        const Config config{placement,
+          {bufferSize, messages, true, cpus->first, cpus->second, durationMs * 1000000},
+          {bench::ParseWait(wait),
+            std::max(messages.max, sizeof(bench::PingMessage)),
+            cpus->first,
+            cpus->second,
+            iterations,
+            iterations / 10},
+          options};
+        try {
+          const Results threads = RunThreads(config);
+#ifdef _WIN32
+          const Results processes;
+          std::cerr << "skipping processes: fork is not available\n";
+#else
+          const Results processes = RunProcesses(config);
+#endif
+          if (!threads.throughput || !threads.latency || !processes.throughput ||
+              !processes.latency) {
+            std::cerr << "run " << bufferSizeText << " " << messageText << " failed\n";
+            status = 1;
+          }
+          Report(json, config, threads, processes);
+        } catch (const std::bad_alloc&) {
+          std::cerr << "skipping buffer size " << bufferSizeText << ": out of memory\n";
+        }
+      }
+    }
+  }
+  return status;
+}
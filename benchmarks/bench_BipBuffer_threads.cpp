@@ -4,16 +4,141 @@
 #define CATCH_CONFIG_RUNNER
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <memory>
+#include <new>
 #include <thread>
 #include <vector>
 
-TEST_CASE("BipBuffer multi-threaded benchmark", "[bipbuffer][concurrent][benchmark]") {
-  constexpr size_t BUFFER_SIZE = 128;
-  std::array<uint8_t, BUFFER_SIZE> buffer{};
+// Count heap allocations per thread so the benchmark can verify the writer's
+// hot path does not allocate. The whole family of global allocation functions
+// is replaced, so every form of new is paired with the matching delete
+static thread_local size_t tAllocations = 0;
 
-  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
-  REQUIRE(layout->bufferSize == BUFFER_SIZE - sizeof(mvi::BipBufferHeader));
+static void* Allocate(std::size_t size, std::align_val_t alignment) noexcept {
+  ++tAllocations;
+  const auto align = static_cast<std::size_t>(alignment);
+  size = std::max<std::size_t>((size + align - 1) / align * align, align);
+#ifdef _WIN32
+  return _aligned_malloc(size, align);
+#else
+  return std::aligned_alloc(align, size);
+#endif
+}
+
+static void* AllocateOrThrow(std::size_t size, std::align_val_t alignment) {
+  if (void* ptr = Allocate(size, alignment)) { return ptr; }
+  throw std::bad_alloc();
+}
+
+static void Deallocate(void* ptr) noexcept {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+static constexpr auto DEFAULT_ALIGNMENT = std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+void* operator new(std::size_t size) {
+  return AllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size) {
+  return AllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept {
+  return Allocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& /*tag*/) noexcept {
+  return Allocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(
+  std::size_t size, std::align_val_t alignment, const std::nothrow_t& /*tag*/) noexcept {
+  return Allocate(size, alignment);
+}
+
+void* operator new[](
+  std::size_t size, std::align_val_t alignment, const std::nothrow_t& /*tag*/) noexcept {
+  return Allocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t /*alignment*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t /*alignment*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t& /*tag*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t& /*tag*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete(
+  void* ptr, std::align_val_t /*alignment*/, const std::nothrow_t& /*tag*/) noexcept {
+  Deallocate(ptr);
+}
+
+void operator delete[](
+  void* ptr, std::align_val_t /*alignment*/, const std::nothrow_t& /*tag*/) noexcept {
+  Deallocate(ptr);
+}
+
+// The v1 header shares one cache line between the reader and writer indices,
+// while the v2 header keeps them on separate cache lines. Both are run with the
+// same 96-byte buffer so the difference is only the false sharing on the header
+TEMPLATE_TEST_CASE("BipBuffer multi-threaded benchmark",
+  "[bipbuffer][concurrent][benchmark]",
+  mvi::BipBufferHeader,
+  mvi::BipBufferHeaderV2) {
+  constexpr size_t BUFFER_SIZE = sizeof(TestType) + 96;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = TestType::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == BUFFER_SIZE - sizeof(TestType));
 
   std::unique_ptr<mvi::BipBufferWriter> writer;
   std::unique_ptr<mvi::BipBufferReader> reader;
@@ -24,7 +149,10 @@ TEST_CASE("BipBuffer multi-threaded benchmark", "[bipbuffer][concurrent][benchma
   }
 
   // Writer thread function
+  size_t writerAllocations = 0;
+  size_t messages = 0;
   auto writerFunc = [&]() {
+    const size_t allocationsBefore = tAllocations;
     for (size_t offset = 0; offset < testData.size(); offset += 32) {
       // Try to reserve space and write data in chunks
       auto reservation = writer->reserve(32);
@@ -32,9 +160,11 @@ TEST_CASE("BipBuffer multi-threaded benchmark", "[bipbuffer][concurrent][benchma
         std::this_thread::yield(); // Yield thread if reservation failed, then try again
         reservation = writer->reserve(32);
       }
-      // std::memcpy(reservation->data(), testData.data() + offset, 32);
-      reservation.reset(); // Automatically commits the data
+      // std::memcpy(reservation.data(), testData.data() + offset, 32);
+      reservation.commit(); // Commits the data
+      ++messages;
     }
+    writerAllocations += tAllocations - allocationsBefore;
   };
 
   // Reader thread function
@@ -70,6 +200,10 @@ TEST_CASE("BipBuffer multi-threaded benchmark", "[bipbuffer][concurrent][benchma
       readerThread.join();
     });
   };
+
+  // Reserving and committing must not touch the heap
+  INFO("messages: " << messages << ", writer allocations: " << writerAllocations);
+  REQUIRE(writerAllocations == 0);
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,354 @@
+#pragma once
+
+// Helpers shared by the standalone benchmarks: CPU topology discovery, thread
+// pinning, aligned allocation, forking, a latency histogram and a minimal JSON
+// writer for machine-readable results
+
+#include <algorithm> // for max, min
+#include <chrono>
+#include <cstdint> // for UINT64_MAX
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifndef _WIN32
+#include <cerrno>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+/// Where the two threads of a benchmark run relative to each other
+enum class Placement {
+  None, // Not pinned, the scheduler decides
+  SameCore, // Two hardware threads (SMT siblings) of the same core
+  SameSocket, // Two different cores of the same socket
+  CrossSocket, // Cores on different sockets
+};
+
+inline const char* PlacementName(Placement placement) {
+  switch (placement) {
+  case Placement::None: return "none";
+  case Placement::SameCore: return "same-core";
+  case Placement::SameSocket: return "same-socket";
+  case Placement::CrossSocket: return "cross-socket";
+  }
+  return "unknown";
+}
+
+/// Returns the placement with the given name, or Placement::None if unknown
+inline Placement ParsePlacement(const std::string& name) {
+  for (const auto placement :
+    {Placement::SameCore, Placement::SameSocket, Placement::CrossSocket}) {
+    if (name == PlacementName(placement)) { return placement; }
+  }
+  return Placement::None;
+}
+
+/// Location of a logical CPU
+struct Cpu {
+  int id;
+  int core;
+  int socket;
+};
+
+/// Reads the topology of the online CPUs the process may run on. Empty where
+/// it can not be determined, in which case only Placement::None is available
+inline std::vector<Cpu> ReadTopology() {
+  std::vector<Cpu> cpus;
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) { return cpus; }
+  for (size_t id = 0; id < size_t(CPU_SETSIZE); ++id) {
+    if (!CPU_ISSET(id, &allowed)) { continue; }
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+    std::ifstream coreFile(base + "core_id");
+    std::ifstream socketFile(base + "physical_package_id");
+    Cpu cpu{int(id), 0, 0};
+    if (!(coreFile >> cpu.core) || !(socketFile >> cpu.socket)) { continue; }
+    cpus.push_back(cpu);
+  }
+#endif
+  return cpus;
+}
+
+/// Picks a pair of CPUs with the given placement, if the machine has one
+inline std::optional<std::pair<int, int>> FindCpuPair(
+  const std::vector<Cpu>& cpus, Placement placement) {
+  if (placement == Placement::None) { return std::make_pair(-1, -1); }
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    for (size_t j = i + 1; j < cpus.size(); ++j) {
+      const Cpu& a = cpus[i];
+      const Cpu& b = cpus[j];
+      const bool sameSocket = a.socket == b.socket;
+      const bool sameCore = sameSocket && a.core == b.core;
+      if ((placement == Placement::SameCore && sameCore) ||
+          (placement == Placement::SameSocket && sameSocket && !sameCore) ||
+          (placement == Placement::CrossSocket && !sameSocket)) {
+        return std::make_pair(a.id, b.id);
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+/// Pins the calling thread to a CPU. Does nothing for a negative CPU or where
+/// pinning is not supported
+inline bool PinThread(int cpu) {
+  if (cpu < 0) { return true; }
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(size_t(cpu), &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+/// Returns the steady clock in nanoseconds
+inline uint64_t NowNs() {
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+}
+
+/// Parses a size with an optional K, M or G suffix (powers of 1024). Returns 0 if invalid
+inline uint64_t ParseSize(const std::string& text) {
+  size_t end = 0;
+  uint64_t value = 0;
+  try {
+    value = std::stoull(text, &end);
+  } catch (const std::exception&) {
+    return 0;
+  }
+  const std::string suffix = text.substr(end);
+  if (suffix == "K" || suffix == "k") { return value << 10; }
+  if (suffix == "M" || suffix == "m") { return value << 20; }
+  if (suffix == "G" || suffix == "g") { return value << 30; }
+  return suffix.empty() ? value : 0;
+}
+
+/// Splits a comma-separated list
+inline std::vector<std::string> SplitList(const std::string& text) {
+  std::vector<std::string> items;
+  size_t start = 0;
+  while (start <= text.size()) {
+    const size_t comma = std::min(text.find(',', start), text.size());
+    if (comma > start) { items.push_back(text.substr(start, comma - start)); }
+    start = comma + 1;
+  }
+  return items;
+}
+
+struct AlignedDelete {
+  size_t alignment;
+
+  void operator()(uint8_t* data) const { ::operator delete[](data, std::align_val_t{alignment}); }
+};
+
+using AlignedBuffer = std::unique_ptr<uint8_t[], AlignedDelete>;
+
+/// Allocates memory with the given alignment and touches every page, so page
+/// faults are not measured. Throws std::bad_alloc
+inline AlignedBuffer AllocateAligned(size_t size, size_t alignment) {
+  AlignedBuffer buffer(
+    static_cast<uint8_t*>(::operator new[](size, std::align_val_t{alignment})),
+    AlignedDelete{alignment});
+  std::fill_n(buffer.get(), size, uint8_t(0));
+  return buffer;
+}
+
+#ifndef _WIN32
+/// Runs `child` in a forked process, which exits with status 0 if it returns
+/// true. Returns the process ID, or -1 if forking failed
+template<typename Function>
+pid_t ForkChild(Function&& child) {
+  const pid_t pid = ::fork();
+  if (pid == 0) { ::_exit(child() ? 0 : 1); }
+  return pid;
+}
+
+/// Waits for a process started by ForkChild(). Returns true if it succeeded
+inline bool JoinChild(pid_t pid) {
+  if (pid < 0) { return false; }
+  int status = 0;
+  while (::waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) { return false; }
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif
+
+/// A fast xorshift generator, so random message sizes do not dominate the measurement
+struct Random {
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+
+  uint64_t next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+};
+
+/**
+ * Histogram of latencies in the style of HdrHistogram: values below 256 are
+ * counted exactly, larger values in log-linear buckets of 128 per power of
+ * two, so every reported value is within 1% of the true one while recording
+ * costs a few instructions and no allocation.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram()
+    : counts_(BUCKETS, 0) {}
+
+  void record(uint64_t value) {
+    ++counts_[Index(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t min() const { return count_ > 0 ? min_ : 0; }
+  uint64_t max() const { return max_; }
+  double mean() const { return count_ > 0 ? double(sum_) / double(count_) : 0.0; }
+
+  /// Returns the value at or below which `percentile` percent of the values fall
+  uint64_t percentile(double percentile) const {
+    if (count_ == 0) { return 0; }
+    const auto rank = uint64_t(double(count_) * percentile / 100.0 + 0.5);
+    uint64_t seen = 0;
+    for (size_t index = 0; index < BUCKETS; ++index) {
+      seen += counts_[index];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        return std::min(HighestEquivalent(index), max_);
+      }
+    }
+    return max_;
+  }
+
+private:
+  static constexpr unsigned SUB_BUCKET_BITS = 7;
+  static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+
+  // Buckets below 2 * SUB_BUCKETS hold one value each. Above, a value whose
+  // highest set bit is b lands in block b - SUB_BUCKET_BITS + 1, indexed by
+  // its top SUB_BUCKET_BITS + 1 bits
+  static size_t Index(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) { return size_t(value); }
+    unsigned highestBit = 0;
+    while ((value >> highestBit) > 1) { ++highestBit; }
+    const unsigned shift = highestBit - SUB_BUCKET_BITS;
+    return size_t(shift * SUB_BUCKETS + (value >> shift));
+  }
+
+  static uint64_t HighestEquivalent(size_t index) {
+    if (index < 2 * SUB_BUCKETS) { return index; }
+    const uint64_t shift = index / SUB_BUCKETS - 1;
+    const uint64_t mantissa = index - shift * SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+  }
+};
+
+/**
+ * Writes one JSON object per result into a JSON array under a top-level
+ * object, without escaping beyond quotes and backslashes, which the
+ * benchmark names never contain anything else of.
+ */
+class JsonWriter {
+public:
+  JsonWriter(std::ostream& out, const std::string& benchmark)
+    : out_(out) {
+    out_ << "{\n  \"benchmark\": \"" << benchmark << "\",\n  \"results\": [";
+  }
+
+  ~JsonWriter() { out_ << "\n  ]\n}\n"; }
+
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  /// Starts a new result object
+  void begin() {
+    out_ << (first_ ? "\n    {" : ",\n    {");
+    first_ = false;
+    firstField_ = true;
+  }
+
+  /// Ends the current result object
+  void end() {
+    out_ << "}";
+    out_.flush();
+  }
+
+  void field(const char* name, const std::string& value) {
+    key(name);
+    out_ << '"';
+    for (const char c : value) {
+      if (c == '"' || c == '\\') { out_ << '\\'; }
+      out_ << c;
+    }
+    out_ << '"';
+  }
+
+  void field(const char* name, const char* value) { field(name, std::string(value)); }
+
+  void field(const char* name, bool value) {
+    key(name);
+    out_ << (value ? "true" : "false");
+  }
+
+  void field(const char* name, uint64_t value) {
+    key(name);
+    out_ << value;
+  }
+
+  void field(const char* name, int value) {
+    key(name);
+    out_ << value;
+  }
+
+  void field(const char* name, double value) {
+    key(name);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    out_ << text;
+  }
+
+private:
+  std::ostream& out_;
+  bool first_ = true;
+  bool firstField_ = true;
+
+  void key(const char* name) {
+    out_ << (firstField_ ? "" : ", ") << '"' << name << "\": ";
+    firstField_ = false;
+  }
+};
+
+} // namespace bench
@@ -0,0 +1,161 @@
+#pragma once
+
+// Ping and pong sides of the round-trip latency benchmarks. The ping side
+// sends timestamped messages through one buffer, the pong side echoes them
+// back through another, as two threads or as two processes
+
+#include "BipBufferHeaderV2.hpp"
+#include "BipBufferReader.hpp"
+#include "BipBufferWait.hpp"
+#include "BipBufferWriter.hpp"
+#include "bench_common.hpp"
+
+#include <chrono>
+#include <cstdint> // for UINT64_MAX
+#include <cstring> // for memcpy
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace bench {
+
+/// How each side waits for the other
+enum class Wait {
+  Yield, // Poll, yielding the CPU between attempts
+  Spin, // WaitStrategy::BusySpin
+  Pause, // WaitStrategy::SpinPause
+  Futex, // WaitStrategy::SpinFutex, with FLAG_WAKEUPS set on both buffers
+};
+
+inline const char* WaitName(Wait wait) {
+  switch (wait) {
+  case Wait::Yield: return "yield";
+  case Wait::Spin: return "spin";
+  case Wait::Pause: return "pause";
+  case Wait::Futex: return "futex";
+  }
+  return "unknown";
+}
+
+/// Returns the wait strategy with the given name, or Wait::Yield if unknown
+inline Wait ParseWait(const std::string& name) {
+  for (const auto wait : {Wait::Spin, Wait::Pause, Wait::Futex}) {
+    if (name == WaitName(wait)) { return wait; }
+  }
+  return Wait::Yield;
+}
+
+/// Flags to create both buffers of a ping-pong with
+inline uint32_t WaitFlags(Wait wait) {
+  return wait == Wait::Futex ? mvi::BipBufferHeaderV2::FLAG_WAKEUPS : 0;
+}
+
+struct PingPongConfig {
+  Wait wait;
+  size_t messageSize; // At least sizeof(PingMessage)
+  int pingCpu;
+  int pongCpu;
+  uint64_t iterations;
+  uint64_t warmup; // Round trips before the measured ones
+};
+
+/// Start of every message, the rest is padding up to the message size
+struct PingMessage {
+  uint64_t sequence;
+  uint64_t sentNs;
+};
+
+/// Sequence telling the pong side to exit
+constexpr uint64_t PING_STOP = UINT64_MAX;
+
+/// The other side is considered dead when it does not respond within this time
+constexpr std::chrono::seconds PING_TIMEOUT{5};
+
+/// One side of a ping-pong, sending into one buffer and receiving from the other
+class PingEndpoint {
+public:
+  PingEndpoint(
+    mvi::BipBufferHeaderV2& out, mvi::BipBufferHeaderV2& in, Wait wait, size_t messageSize)
+    : writer_(out),
+      reader_(in),
+      wait_(wait),
+      messageSize_(messageSize) {}
+
+  bool send(const PingMessage& message) {
+    auto reservation = wait_ == Wait::Yield
+      ? writer_.reserve(messageSize_)
+      : writer_.reserve(messageSize_, Strategy(), PING_TIMEOUT);
+    const uint64_t deadline = NowNs() + TIMEOUT_NS;
+    while (!reservation && wait_ == Wait::Yield && NowNs() < deadline) {
+      std::this_thread::yield();
+      reservation = writer_.reserve(messageSize_);
+    }
+    if (!reservation) { return false; }
+    std::memcpy(reservation.data(), &message, sizeof(message));
+    reservation.commit();
+    return true;
+  }
+
+  bool receive(PingMessage& message) {
+    std::string_view data =
+      wait_ == Wait::Yield ? reader_.read() : reader_.read(Strategy(), PING_TIMEOUT);
+    const uint64_t deadline = NowNs() + TIMEOUT_NS;
+    while (data.empty() && wait_ == Wait::Yield && NowNs() < deadline) {
+      std::this_thread::yield();
+      data = reader_.read();
+    }
+    if (data.size() < messageSize_) { return false; }
+    std::memcpy(&message, data.data(), sizeof(message));
+    return reader_.advance(messageSize_);
+  }
+
+private:
+  static constexpr uint64_t TIMEOUT_NS =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(PING_TIMEOUT).count();
+
+  mvi::BipBufferWriter writer_;
+  mvi::BipBufferReader reader_;
+  Wait wait_;
+  size_t messageSize_;
+
+  mvi::WaitStrategy Strategy() const {
+    if (wait_ == Wait::Spin) { return mvi::WaitStrategy::BusySpin; }
+    if (wait_ == Wait::Pause) { return mvi::WaitStrategy::SpinPause; }
+    return mvi::WaitStrategy::SpinFutex;
+  }
+};
+
+/// Echoes messages until told to stop. Returns false if the ping side went silent
+inline bool Pong(
+  mvi::BipBufferHeaderV2& ping, mvi::BipBufferHeaderV2& pong, const PingPongConfig& config) {
+  PinThread(config.pongCpu);
+  PingEndpoint endpoint{pong, ping, config.wait, config.messageSize};
+  PingMessage message{};
+  while (endpoint.receive(message)) {
+    if (message.sequence == PING_STOP) { return true; }
+    if (!endpoint.send(message)) { return false; }
+  }
+  return false;
+}
+
+/// Measures round trips, then stops the pong side. Returns nothing if the
+/// pong side went silent
+inline std::optional<LatencyHistogram> Ping(
+  mvi::BipBufferHeaderV2& ping, mvi::BipBufferHeaderV2& pong, const PingPongConfig& config) {
+  PinThread(config.pingCpu);
+  PingEndpoint endpoint{ping, pong, config.wait, config.messageSize};
+  LatencyHistogram histogram;
+  for (uint64_t sequence = 0; sequence < config.warmup + config.iterations; ++sequence) {
+    PingMessage reply{};
+    if (!endpoint.send(PingMessage{sequence, NowNs()}) || !endpoint.receive(reply) ||
+        reply.sequence != sequence) {
+      return std::nullopt;
+    }
+    if (sequence >= config.warmup) { histogram.record(NowNs() - reply.sentNs); }
+  }
+  if (!endpoint.send(PingMessage{PING_STOP, 0})) { return std::nullopt; }
+  return histogram;
+}
+
+} // namespace bench
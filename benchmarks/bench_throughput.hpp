@@ -0,0 +1,212 @@
+#pragma once
+
+// Producer and consumer loops of the throughput benchmarks, usable from two
+// threads or from two processes sharing the buffer
+
+#include "BipBufferHeaderV2.hpp"
+#include "BipBufferReader.hpp"
+#include "BipBufferWait.hpp"
+#include "BipBufferWriter.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm> // for min
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring> // for memcpy
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+/// Distribution of message sizes: fixed, or uniformly distributed between two bounds
+struct MessageSizes {
+  size_t min;
+  size_t max;
+
+  std::string name() const {
+    if (min == max) { return "fixed:" + std::to_string(min); }
+    return "uniform:" + std::to_string(min) + "-" + std::to_string(max);
+  }
+
+  static bool Parse(const std::string& text, MessageSizes& sizes) {
+    if (text.rfind("fixed:", 0) == 0) {
+      sizes.min = sizes.max = size_t(ParseSize(text.substr(6)));
+      return sizes.min > 0;
+    }
+    const size_t dash = text.find('-');
+    if (text.rfind("uniform:", 0) == 0 && dash != std::string::npos) {
+      sizes.min = size_t(ParseSize(text.substr(8, dash - 8)));
+      sizes.max = size_t(ParseSize(text.substr(dash + 1)));
+      return sizes.min > 0 && sizes.max >= sizes.min;
+    }
+    return false;
+  }
+};
+
+struct ThroughputConfig {
+  size_t bufferSize;
+  MessageSizes messages;
+  bool copy;
+  int writerCpu;
+  int readerCpu;
+  uint64_t durationNs;
+};
+
+/**
+ * Coordinates the producer and the consumer of a throughput run. Lives next to
+ * the buffer, so it works the same whether the two sides are threads or
+ * processes mapping the same SharedMemory.
+ */
+struct alignas(mvi::CACHE_LINE_SIZE) ThroughputControl {
+  std::atomic<uint32_t> started{0}; // Sides ready to start
+  std::atomic<uint32_t> producing{1}; // Cleared when the producer stops
+  std::atomic<uint64_t> produced{0}; // Bytes produced, valid once producing is cleared
+  std::atomic<uint64_t> startNs{0}; // Steady clock when the producer started
+  std::atomic<uint64_t> endNs{0}; // Steady clock when the consumer drained the last byte
+
+  double seconds() const { return double(endNs.load() - startNs.load()) / 1e9; }
+};
+
+struct ThroughputResult {
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  uint64_t wastedBytes = 0; // Skipped at the end of the buffer when reservations wrapped
+  uint64_t reserveFailures = 0; // reserve() calls that found the buffer full
+  double seconds = 0;
+
+  double messagesPerSecond() const { return double(messages) / seconds; }
+  double gigabytesPerSecond() const { return double(bytes) / seconds / 1e9; }
+  double wastedPercent() const {
+    const uint64_t used = bytes + wastedBytes;
+    return used > 0 ? 100.0 * double(wastedBytes) / double(used) : 0.0;
+  }
+};
+
+/// How long either side waits for the other to start, or the producer waits
+/// for space after the run should have ended, before giving up
+constexpr std::chrono::seconds PEER_TIMEOUT{5};
+constexpr uint64_t PEER_TIMEOUT_NS =
+  std::chrono::duration_cast<std::chrono::nanoseconds>(PEER_TIMEOUT).count();
+
+/// Spins briefly while waiting for the other side, then yields so the two
+/// sides still make progress when they share a CPU
+inline void Backoff(size_t& attempts) {
+  constexpr size_t SPINS = 64;
+  if (++attempts < SPINS) {
+    mvi::CpuRelax();
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+/// Waits for both sides to arrive. Returns false if the other side did not
+/// arrive within PEER_TIMEOUT, for example because its process failed
+inline bool WaitForStart(ThroughputControl& control) {
+  control.started.fetch_add(1);
+  const uint64_t deadline = NowNs() + PEER_TIMEOUT_NS;
+  for (size_t attempts = 0; control.started.load() < 2;) {
+    if (NowNs() >= deadline) { return false; }
+    Backoff(attempts);
+  }
+  return true;
+}
+
+/// Writes messages for the configured duration. The returned result lacks
+/// the duration, which is known once the consumer has finished. Returns
+/// std::nullopt if the consumer did not start or stopped consuming
+inline std::optional<ThroughputResult> Produce(
+  mvi::BipBufferHeaderV2& layout, ThroughputControl& control, const ThroughputConfig& config) {
+  // Precomputed sizes, so drawing a size costs a load instead of a random number
+  constexpr size_t SIZE_TABLE_LENGTH = 4096;
+  std::vector<size_t> sizes(SIZE_TABLE_LENGTH);
+  Random random;
+  for (size_t& size : sizes) {
+    const size_t span = config.messages.max - config.messages.min + 1;
+    size = config.messages.min + size_t(random.next() % span);
+  }
+  std::vector<uint8_t> source(config.messages.max, 0xAB);
+
+  PinThread(config.writerCpu);
+  mvi::BipBufferWriter writer{layout};
+  const uint8_t* buffer = layout.buffer();
+  if (!WaitForStart(control)) {
+    // Let a consumer that arrives late finish at once
+    control.producing.store(0);
+    return std::nullopt;
+  }
+  const uint64_t startNs = NowNs();
+  control.startNs.store(startNs);
+  const uint64_t stallNs = config.durationNs + PEER_TIMEOUT_NS;
+
+  ThroughputResult result;
+  size_t previousEnd = 0;
+  bool stalled = false;
+  for (size_t i = 0;; ++i) {
+    if ((i & 255) == 0 && NowNs() - startNs >= config.durationNs) { break; }
+    const size_t length = sizes[i & (SIZE_TABLE_LENGTH - 1)];
+    auto reservation = writer.reserve(length);
+    for (size_t attempts = 0; !reservation; reservation = writer.reserve(length)) {
+      ++result.reserveFailures;
+      // A consumer that stopped consuming never frees the space
+      if ((attempts & 255) == 0 && NowNs() - startNs >= stallNs) {
+        stalled = true;
+        break;
+      }
+      Backoff(attempts);
+    }
+    if (stalled) { break; }
+    const auto offset = size_t(reservation.data() - buffer);
+    if (offset < previousEnd) { result.wastedBytes += config.bufferSize - previousEnd; }
+    previousEnd = offset + length;
+    if (config.copy) { std::memcpy(reservation.data(), source.data(), length); }
+    reservation.commit();
+    ++result.messages;
+    result.bytes += length;
+  }
+  writer.flush();
+  control.produced.store(result.bytes);
+  control.producing.store(0);
+  if (stalled) { return std::nullopt; }
+  return result;
+}
+
+/// Reads until the producer has stopped and every byte was consumed. Returns
+/// false if the producer did not start
+inline bool Consume(
+  mvi::BipBufferHeaderV2& layout, ThroughputControl& control, const ThroughputConfig& config) {
+  PinThread(config.readerCpu);
+  mvi::BipBufferReader reader{layout};
+  constexpr size_t SINK_SIZE = 64 * 1024;
+  std::vector<uint8_t> sink(config.copy ? SINK_SIZE : 0);
+  if (!WaitForStart(control)) { return false; }
+
+  uint64_t consumed = 0;
+  size_t attempts = 0;
+  for (;;) {
+    const auto segments = reader.readAll();
+    const size_t available = segments[0].size() + segments[1].size();
+    if (available == 0) {
+      if (control.producing.load() == 0 && consumed == control.produced.load()) { break; }
+      Backoff(attempts);
+      continue;
+    }
+    attempts = 0;
+    if (config.copy) {
+      for (const auto& segment : segments) {
+        for (size_t offset = 0; offset < segment.size(); offset += SINK_SIZE) {
+          const size_t length = std::min(SINK_SIZE, segment.size() - offset);
+          std::memcpy(sink.data(), segment.data() + offset, length);
+        }
+      }
+    }
+    (void)reader.advance(available);
+    consumed += available;
+  }
+  control.endNs.store(NowNs());
+  return true;
+}
+
+} // namespace bench
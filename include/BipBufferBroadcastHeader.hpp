@@ -0,0 +1,106 @@
+#pragma once
+
+#include "BipBufferHeaderV2.hpp"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace mvi {
+
+/**
+ * A header structure for a bip buffer with one writer and several independent
+ * readers, each of which sees every byte written. Instead of a single `read`
+ * index it holds a fixed table of reader cursors, each on its own cache line.
+ * A BipBufferWriter attached to this header computes free space against the
+ * slowest registered reader, so data is never overwritten before every reader
+ * has consumed it.
+ *
+ * Readers register through the header, which may live in a SharedMemory area
+ * shared with other processes. A newly registered reader is positioned by the
+ * writer at the current write position the next time the writer publishes, so
+ * it receives everything written from then on. Until then its cursor is
+ * JOINING and the reader sees no data. A reader that exits without
+ * unregistering holds back the writer, so a supervisor that detects a dead
+ * consumer should unregister its slot.
+ */
+struct alignas(CACHE_LINE_SIZE) BipBufferBroadcastHeader {
+  static constexpr uint32_t MAGIC = 0x43424221; // "!BBC" in little-endian byte order
+  static constexpr uint32_t VERSION = 1;
+
+  static constexpr size_t MAX_READERS = 16;
+  static constexpr uint64_t FREE = UINT64_MAX; // Cursor value of an unused slot
+  static constexpr uint64_t JOINING = UINT64_MAX - 1; // Cursor value of a slot awaiting the writer
+
+  /// A reader cursor, padded to a cache line so readers do not contend
+  struct alignas(CACHE_LINE_SIZE) Cursor {
+    std::atomic<uint64_t> read; // Read position, or FREE or JOINING
+  };
+
+  // Metadata, written once by Create() and read-only afterwards
+  uint32_t magic; // Always MAGIC
+  uint32_t version; // Layout version, always VERSION
+  uint64_t bufferSize; // Size of the buffer
+
+  // Incremented by joining readers, polled by the writer when it publishes
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> joinRequests;
+
+  // Producer cache line, only written by the writer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> write; // Write position
+  std::atomic<uint64_t> last; // Marks the last valid byte in the buffer
+
+  // Consumer cache lines, each only written by its reader (and by the writer
+  // when admitting a joining reader)
+  Cursor readers[MAX_READERS];
+
+  /// Returns a const pointer to the beginning of the circular buffer
+  const uint8_t* buffer() const;
+
+  /// Returns a pointer to the beginning of the circular buffer
+  uint8_t* buffer();
+
+  /**
+   * Claims a free reader slot. The returned slot is passed to the
+   * BipBufferReader constructor and must be released with unregisterReader()
+   * once that reader is no longer used.
+   *
+   * @return The index of the claimed slot, or an empty optional if all
+   *   MAX_READERS slots are in use.
+   */
+  std::optional<size_t> registerReader();
+
+  /// Releases a reader slot claimed with registerReader(), so the writer no
+  /// longer waits for that reader
+  void unregisterReader(size_t slot);
+
+  /**
+   * Instantiate a BipBufferBroadcastHeader from an existing block of memory,
+   * with all reader slots free.
+   *
+   * @param data Pointer to allocated memory where the header will be constructed.
+   *   Must be aligned to CACHE_LINE_SIZE.
+   * @param size Size of the allocated memory block. The memory must be large
+   *   enough to hold the full header structure, plus at least one byte for the
+   *   buffer.
+   * @return Pointer to the initialized BipBufferBroadcastHeader instance or
+   *   nullptr if the parameters are invalid.
+   */
+  static BipBufferBroadcastHeader* Create(uint8_t* data, size_t size);
+
+  /**
+   * Attach to a BipBufferBroadcastHeader previously initialized with Create(),
+   * for example by another process sharing the same memory.
+   *
+   * @return Pointer to the existing BipBufferBroadcastHeader or nullptr if the
+   *   memory does not hold a valid header of this version, or is too small for
+   *   the buffer size recorded in it.
+   */
+  static BipBufferBroadcastHeader* Attach(uint8_t* data, size_t size);
+
+private:
+  BipBufferBroadcastHeader() = default;
+};
+
+} // namespace mvi
@@ -0,0 +1,260 @@
+#pragma once
+
+// C++20 coroutine support for bip buffers. This header is header-only so that
+// the library itself can be built as C++17; it is empty unless the including
+// translation unit is compiled with coroutine support.
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include "BipBufferReader.hpp"
+#include "BipBufferWait.hpp"
+#include "BipBufferWriter.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mvi {
+
+/**
+ * A fire-and-forget coroutine run by a BipBufferScheduler. A coroutine
+ * returning BipTask does not start until it is passed to
+ * BipBufferScheduler::spawn(), which takes ownership of it.
+ */
+class BipTask {
+public:
+  struct promise_type {
+    BipTask get_return_object() {
+      return BipTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  BipTask(BipTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  BipTask& operator=(BipTask&&) = delete;
+  BipTask(const BipTask&) = delete;
+  BipTask& operator=(const BipTask&) = delete;
+
+  /// Destroys the coroutine if it was never spawned
+  ~BipTask() {
+    if (handle_) { handle_.destroy(); }
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit BipTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  friend class BipBufferScheduler;
+};
+
+/**
+ * A single-threaded scheduler for coroutines waiting on bip buffers. Suspended
+ * coroutines are kept in a list together with a readiness check, and run()
+ * polls the list, resuming every coroutine whose buffer has data or space.
+ * This multiplexes many streams onto one thread without a thread per stream;
+ * use one scheduler per thread to spread streams over a few threads.
+ */
+class BipBufferScheduler {
+public:
+  BipBufferScheduler() = default;
+
+  /// Destroys any tasks that have not completed
+  ~BipBufferScheduler() {
+    for (auto task : tasks_) {
+      task.destroy();
+    }
+  }
+
+  BipBufferScheduler(const BipBufferScheduler&) = delete;
+  BipBufferScheduler& operator=(const BipBufferScheduler&) = delete;
+  BipBufferScheduler(BipBufferScheduler&&) = delete;
+  BipBufferScheduler& operator=(BipBufferScheduler&&) = delete;
+
+  /// Takes ownership of a task and schedules it to start on the next poll()
+  void spawn(BipTask task) {
+    auto handle = std::exchange(task.handle_, {});
+    tasks_.push_back(handle);
+    ready_.push_back(handle);
+  }
+
+  /// Returns the number of spawned tasks that have not completed
+  size_t size() const { return tasks_.size(); }
+
+  /**
+   * Resumes every task that is ready to run, then checks the suspended tasks
+   * and queues those whose buffer became ready for the next call.
+   *
+   * @return The number of tasks resumed.
+   */
+  size_t poll() {
+    resuming_.swap(ready_);
+    for (auto handle : resuming_) {
+      handle.resume();
+      if (handle.done()) { finish(handle); }
+    }
+    const size_t resumed = resuming_.size();
+    resuming_.clear();
+
+    for (size_t i = 0; i < waiting_.size();) {
+      if (waiting_[i].ready(waiting_[i].awaiter)) {
+        ready_.push_back(waiting_[i].handle);
+        waiting_[i] = waiting_.back();
+        waiting_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+    return resumed;
+  }
+
+  /**
+   * Runs until all spawned tasks have completed. When no task could make
+   * progress the thread waits with the given strategy before polling again;
+   * SpinFutex has no single word to sleep on here and yields instead.
+   */
+  void run(WaitStrategy strategy = WaitStrategy::SpinPause) {
+    while (!tasks_.empty()) {
+      if (poll() > 0 || !ready_.empty()) { continue; }
+      if (strategy == WaitStrategy::SpinPause) {
+        CpuRelax();
+      } else if (strategy == WaitStrategy::SpinFutex) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  struct Waiter {
+    bool (*ready)(void* awaiter); // Completes the awaited operation if possible
+    void* awaiter;
+    std::coroutine_handle<> handle;
+  };
+
+  std::vector<std::coroutine_handle<BipTask::promise_type>> tasks_; // Owned, not completed
+  std::vector<std::coroutine_handle<>> ready_; // Queued for the next poll()
+  std::vector<std::coroutine_handle<>> resuming_; // Being resumed by poll()
+  std::vector<Waiter> waiting_; // Suspended until their buffer is ready
+
+  void finish(std::coroutine_handle<> handle) {
+    for (size_t i = 0; i < tasks_.size(); ++i) {
+      if (tasks_[i].address() == handle.address()) {
+        tasks_[i].destroy();
+        tasks_[i] = tasks_.back();
+        tasks_.pop_back();
+        return;
+      }
+    }
+  }
+
+  void suspend(bool (*ready)(void*), void* awaiter, std::coroutine_handle<> handle) {
+    waiting_.push_back({ready, awaiter, handle});
+  }
+
+  friend class BipBufferAsyncReader;
+  friend class BipBufferAsyncWriter;
+};
+
+/**
+ * Awaitable reads from a BipBufferReader. `co_await reader.next()` returns
+ * the next available bytes, suspending the calling BipTask until the writer
+ * publishes data. As with BipBufferReader::read(), the data stays in the
+ * buffer until it is consumed with advance().
+ */
+class BipBufferAsyncReader {
+public:
+  BipBufferAsyncReader(BipBufferScheduler& scheduler, BipBufferReader& reader)
+    : scheduler_(scheduler),
+      reader_(reader) {}
+
+  class NextAwaiter {
+  public:
+    bool await_ready() { return poll(this); }
+    void await_suspend(std::coroutine_handle<> handle) {
+      owner_.scheduler_.suspend(&NextAwaiter::poll, this, handle);
+    }
+    std::string_view await_resume() const { return data_; }
+
+  private:
+    BipBufferAsyncReader& owner_;
+    std::string_view data_;
+
+    explicit NextAwaiter(BipBufferAsyncReader& owner) : owner_(owner) {}
+
+    static bool poll(void* self) {
+      auto awaiter = static_cast<NextAwaiter*>(self);
+      awaiter->data_ = awaiter->owner_.reader_.read();
+      return !awaiter->data_.empty();
+    }
+
+    friend class BipBufferAsyncReader;
+  };
+
+  /// Returns an awaitable for the next available bytes
+  NextAwaiter next() { return NextAwaiter{*this}; }
+
+  /// Consumes bytes returned by next(), see BipBufferReader::advance()
+  [[nodiscard]] bool advance(size_t count) { return reader_.advance(count); }
+
+private:
+  BipBufferScheduler& scheduler_;
+  BipBufferReader& reader_;
+};
+
+/**
+ * Awaitable reservations from a BipBufferWriter. `co_await writer.reserve(n)`
+ * returns a reservation of `n` bytes, suspending the calling BipTask until the
+ * reader frees up enough space. The reservation is committed as usual.
+ */
+class BipBufferAsyncWriter {
+public:
+  BipBufferAsyncWriter(BipBufferScheduler& scheduler, BipBufferWriter& writer)
+    : scheduler_(scheduler),
+      writer_(writer) {}
+
+  class ReserveAwaiter {
+  public:
+    bool await_ready() { return poll(this); }
+    void await_suspend(std::coroutine_handle<> handle) {
+      owner_.scheduler_.suspend(&ReserveAwaiter::poll, this, handle);
+    }
+    BipBufferWriterReservation await_resume() { return std::move(reservation_); }
+
+  private:
+    BipBufferAsyncWriter& owner_;
+    size_t length_;
+    BipBufferWriterReservation reservation_;
+
+    ReserveAwaiter(BipBufferAsyncWriter& owner, size_t length) : owner_(owner), length_(length) {}
+
+    static bool poll(void* self) {
+      auto awaiter = static_cast<ReserveAwaiter*>(self);
+      awaiter->reservation_ = awaiter->owner_.writer_.reserve(awaiter->length_);
+      return bool(awaiter->reservation_);
+    }
+
+    friend class BipBufferAsyncWriter;
+  };
+
+  /// Returns an awaitable for a reservation of `length` bytes. A length that
+  /// can never fit in the buffer suspends the task forever.
+  ReserveAwaiter reserve(size_t length) { return ReserveAwaiter{*this, length}; }
+
+  /// Publishes batched commits, see BipBufferWriter::flush()
+  void flush() { writer_.flush(); }
+
+private:
+  BipBufferScheduler& scheduler_;
+  BipBufferWriter& writer_;
+};
+
+} // namespace mvi
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <system_error>
+
+namespace mvi {
+
+/// How a bip buffer in a file-backed mapping is flushed to its file, see
+/// BipBufferWriter::setDurability()
+enum class Durability {
+  None, // Leave write-back to the kernel, the buffer survives process crashes only
+  Async, // Schedule write-back on every publish without waiting for it (MS_ASYNC)
+  Sync, // Wait for write-back on every publish (MS_SYNC), survives power loss
+};
+
+/**
+ * Flushes a range of a file-backed mapping to its file. The range is widened
+ * to whole pages. Does nothing for Durability::None or an empty range.
+ *
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> SyncMemory(const void* data, size_t length, Durability durability);
+
+} // namespace mvi
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "BipBufferReader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace mvi {
+
+/**
+ * Writes the contents of a bip buffer to a file asynchronously, straight from
+ * the buffer's memory. Readable bytes are submitted as positioned writes
+ * without being consumed, several writes are kept in flight, and the reader
+ * is only advanced past a write once it and every write before it have
+ * completed. The producer therefore never overwrites bytes the kernel is
+ * still reading, and a slow disk only holds back the space of the writes in
+ * flight instead of stalling the consuming thread in write().
+ *
+ * On Linux the writes are submitted to an io_uring, using fixed buffer writes
+ * when the memory holding the buffer has been registered with
+ * registerBuffer(). Where io_uring is not available or can not write, for
+ * example on kernels before 5.6 or when it is disabled, a worker thread
+ * performs the writes with pwritev(), merging writes to adjacent file offsets
+ * into a single call.
+ *
+ * The sink is driven by its owner, which calls poll() whenever convenient and
+ * wait() when it has nothing else to do. Not supported on Windows.
+ */
+class BipBufferFileSink {
+public:
+  enum class Mode {
+    Auto, // io_uring if available, otherwise the worker thread
+    IoUring, // io_uring only, open() fails if it is not available
+    Thread, // Always use the worker thread
+  };
+
+  /// Largest single write submitted, larger spans are split to keep more writes in flight
+  static constexpr size_t MAX_WRITE_SIZE = size_t(1) << 20;
+
+  /// Construct a sink that consumes the given reader, which must outlive it
+  explicit BipBufferFileSink(BipBufferReader& reader);
+
+  /// Waits for the writes in flight and closes the sink on destruction
+  ~BipBufferFileSink();
+
+  // The worker thread refers to the sink, so it can neither be copied nor moved
+  BipBufferFileSink(const BipBufferFileSink&) = delete;
+  BipBufferFileSink& operator=(const BipBufferFileSink&) = delete;
+  BipBufferFileSink(BipBufferFileSink&&) = delete;
+  BipBufferFileSink& operator=(BipBufferFileSink&&) = delete;
+
+  /**
+   * Start writing to a file descriptor, which is not owned by the sink.
+   *
+   * @param fd a file descriptor opened for writing, supporting positioned writes
+   * @param offset the file offset at which the first byte is written
+   * @param queueDepth the maximum number of writes in flight
+   * @param mode which implementation to use
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> open(
+    int fd, uint64_t offset, size_t queueDepth, Mode mode = Mode::Auto);
+
+  /**
+   * Register the memory holding the buffer with the io_uring, for example the
+   * whole SharedMemory area, so writes from it skip pinning the pages on every
+   * submission. Must be called while no writes are in flight. Does nothing
+   * when the worker thread is used.
+   *
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> registerBuffer(const void* data, size_t size);
+
+  /**
+   * Advances the reader past completed writes and submits newly readable
+   * bytes, without blocking.
+   *
+   * @return std::nullopt if the operation was successful, otherwise the first
+   *   error of a write or a submission, after which the sink stops writing
+   */
+  std::optional<std::system_error> poll();
+
+  /// Blocks until at least one write completes, if any are in flight, then calls poll()
+  std::optional<std::system_error> wait();
+
+  /// Writes everything that is readable now and waits until it has been written
+  std::optional<std::system_error> drain();
+
+  /// Waits for the writes in flight and stops the sink, leaving the rest of
+  /// the data in the buffer
+  std::optional<std::system_error> close();
+
+  /// Returns true if writes are submitted to an io_uring
+  bool usingIoUring() const { return ring_ != nullptr; }
+
+  /// Returns the number of writes in flight
+  size_t inFlight() const { return count_; }
+
+  /// Returns the file offset following the last byte written and consumed
+  uint64_t offset() const { return completedOffset_; }
+
+private:
+  struct Ring; // io_uring state, see BipBufferFileSink.cpp
+  struct Worker; // Worker thread state, see BipBufferFileSink.cpp
+
+  // A write in flight, in submission order
+  struct Write {
+    const uint8_t* data;
+    size_t length;
+    uint64_t offset;
+    size_t written; // Bytes completed so far, short writes are resubmitted
+  };
+
+  BipBufferReader& reader_;
+  int fd_ = -1;
+  std::unique_ptr<Ring> ring_;
+  std::unique_ptr<Worker> worker_;
+  std::vector<Write> writes_; // Circular queue of `queueDepth` slots
+  size_t head_ = 0; // Slot of the oldest write in flight
+  size_t count_ = 0; // Number of writes in flight
+  size_t outstanding_ = 0; // Submissions the kernel or the worker has not completed yet
+  size_t submittedBytes_ = 0; // Readable bytes covered by the writes in flight
+  uint64_t submittedOffset_ = 0; // File offset of the next write
+  uint64_t completedOffset_ = 0; // File offset following the consumed bytes
+  std::optional<std::system_error> error_; // First error, stops the sink
+
+  // Hands a write to the io_uring or the worker thread
+  void submit(size_t slot);
+
+  // Collects completions, waiting for at least one if `block` is set, and
+  // retires the completed writes at the head of the queue
+  std::optional<std::system_error> reap(bool block);
+
+  // Records the result of the write in `slot`
+  void complete(size_t slot, int64_t result);
+};
+
+} // namespace mvi
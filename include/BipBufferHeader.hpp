@@ -36,6 +36,18 @@ struct alignas(alignof(std::atomic<uint64_t>)) BipBufferHeader {
    */
   static BipBufferHeader* Create(uint8_t* data, size_t size);
 
+  /**
+   * Attach to a BipBufferHeader previously initialized with Create(), for
+   * example one persisted in a file-backed mapping by an earlier process. The
+   * header has no magic number, so it is only checked for consistency.
+   *
+   * @param data Pointer to the start of the header.
+   * @param size Size of the memory block holding the header and buffer.
+   * @return Pointer to the existing BipBufferHeader or nullptr if the buffer
+   *   size or any of the positions in it do not fit the memory block.
+   */
+  static BipBufferHeader* Attach(uint8_t* data, size_t size);
+
 private:
   BipBufferHeader() = default;
 };
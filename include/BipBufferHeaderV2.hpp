@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace mvi {
+
+/// Assumed size of a CPU cache line, used to keep producer and consumer state apart
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+struct BipBufferStatistics;
+
+/**
+ * A versioned header structure for a BipBuffer. It tracks the same read,
+ * write, and end of data positions as BipBufferHeader, but places the indices
+ * owned by the writer (`write`, `last`) and the index owned by the reader
+ * (`read`) on separate cache lines so that publishing one side does not
+ * invalidate the cache line the other side is polling. The header starts with
+ * a magic and version word, which allows it to be told apart from a
+ * BipBufferHeader when attaching to existing memory such as a SharedMemory area.
+ *
+ * Each side's cache line also holds a wait word that the other side sets
+ * before blocking in the kernel. It sits with the fields the waker already
+ * owns, so checking it after publishing does not touch the other side's line.
+ *
+ * A header created with CreateMirrored() describes a buffer that is mapped a
+ * second time directly after its end, see SharedMemory::Options::mirror. Data
+ * that wraps around the end of such a buffer is still contiguous in memory, so
+ * reservations and reads are never split, `last` is unused and no space is
+ * wasted at the end of the buffer.
+ *
+ * The buffer of a non-mirrored header can grow while in use. The writer
+ * requests a larger size by storing `requestedSize` and bumping `generation`,
+ * and keeps using the current size until the reader has mapped the larger
+ * buffer and acknowledged the generation. The current size is the last
+ * acknowledged size, see BipBufferWriter::grow().
+ *
+ * A header created with FLAG_STATISTICS is followed by a BipBufferStatistics
+ * block, which the buffer starts after.
+ */
+struct alignas(CACHE_LINE_SIZE) BipBufferHeaderV2 {
+  static constexpr uint32_t MAGIC = 0x50494221; // "!BIP" in little-endian byte order
+  static constexpr uint32_t VERSION = 2;
+
+  /// Flag enabling kernel wakeups: both sides check the wait words after
+  /// publishing and wake a peer blocked with WaitStrategy::SpinFutex
+  static constexpr uint32_t FLAG_WAKEUPS = 1;
+
+  /// Flag set by CreateMirrored(): the buffer is followed by a mirror of itself
+  static constexpr uint32_t FLAG_MIRRORED = 2;
+
+  /// Flag enabling the BipBufferStatistics counters, placed directly after the header
+  static constexpr uint32_t FLAG_STATISTICS = 4;
+
+  // Bits of the wait words
+  static constexpr uint32_t WAIT_SLEEPING = 1; // Blocked in FutexWait()
+  static constexpr uint32_t WAIT_NOTIFY = 2; // Waiting for a BipBufferNotifier signal
+
+  // Metadata, written once by Create() and read-only afterwards
+  uint32_t magic; // Always MAGIC
+  uint32_t version; // Layout version, always VERSION
+  uint64_t bufferSize; // Size of the buffer at creation
+  uint32_t flags; // Combination of FLAG_ values
+  uint32_t bufferOffset; // Offset of the buffer from the start of the header
+
+  // Producer cache line, only written by the writer (except `readerWaiting`)
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> write; // Write position
+  std::atomic<uint64_t> last; // Marks the last valid byte in the buffer
+  std::atomic<uint32_t> readerWaiting; // Set by a reader blocked in the kernel, rarely written
+  std::atomic<uint32_t> generation; // Number of growth requests, rarely written
+  std::atomic<uint64_t> requestedSize; // Buffer size requested by the latest growth request
+
+  // Consumer cache line, only written by the reader (except `writerWaiting`)
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> read; // Read position
+  std::atomic<uint32_t> writerWaiting; // Set by a writer blocked in the kernel, rarely written
+  std::atomic<uint32_t> acknowledgedGeneration; // Latest growth request mapped by the reader
+  std::atomic<uint64_t> acknowledgedSize; // Current buffer size, grown once acknowledged
+
+  /// Returns a const pointer to the beginning of the circular buffer
+  const uint8_t* buffer() const;
+
+  /// Returns a pointer to the beginning of the circular buffer
+  uint8_t* buffer();
+
+  /// Returns the counters of a header created with FLAG_STATISTICS, else nullptr
+  const BipBufferStatistics* statistics() const;
+
+  /// Returns the counters of a header created with FLAG_STATISTICS, else nullptr
+  BipBufferStatistics* statistics();
+
+  /// Returns the number of bytes Create() places before the buffer for the given flags
+  static size_t HeaderSize(uint32_t flags);
+
+  /**
+   * Instantiate a BipBufferHeaderV2 from an existing block of memory.
+   *
+   * @param data Pointer to allocated memory where the header will be constructed.
+   *   Must be aligned to CACHE_LINE_SIZE.
+   * @param size Size of the allocated memory block. The memory must be large
+   *   enough to hold the full header structure (192 bytes, see HeaderSize()),
+   *   plus at least one byte for the buffer.
+   * @param flags Combination of FLAG_ values, except FLAG_MIRRORED.
+   * @return Pointer to the initialized BipBufferHeaderV2 instance or nullptr if
+   *   the parameters are invalid.
+   */
+  static BipBufferHeaderV2* Create(uint8_t* data, size_t size, uint32_t flags = 0);
+
+  /**
+   * Instantiate a BipBufferHeaderV2 for a mirrored buffer. The buffer starts
+   * at `bufferOffset` and extends to the end of the memory block, and the
+   * caller guarantees that it is mapped a second time directly after the end
+   * of the block, for example by opening a SharedMemory with
+   * `Options{true, bufferOffset}`.
+   *
+   * @param data Pointer to the start of the memory block. Must be aligned to
+   *   CACHE_LINE_SIZE.
+   * @param size Size of the memory block, not including the mirror.
+   * @param bufferOffset Offset of the buffer, at least HeaderSize(flags) and a
+   *   multiple of CACHE_LINE_SIZE. Usually the page size, since mirrored
+   *   mappings start at page boundaries.
+   * @param flags Combination of FLAG_ values, FLAG_MIRRORED is always added.
+   * @return Pointer to the initialized BipBufferHeaderV2 instance or nullptr if
+   *   the parameters are invalid.
+   */
+  static BipBufferHeaderV2* CreateMirrored(
+    uint8_t* data, size_t size, size_t bufferOffset, uint32_t flags = 0);
+
+  /**
+   * Attach to a BipBufferHeaderV2 previously initialized with Create(), for
+   * example by another process sharing the same memory.
+   *
+   * @param data Pointer to the start of the header.
+   * @param size Size of the memory block holding the header and buffer.
+   * @return Pointer to the existing BipBufferHeaderV2 or nullptr if the memory
+   *   does not hold a valid header of this version, or is too small for the
+   *   current buffer size recorded in it.
+   */
+  static BipBufferHeaderV2* Attach(uint8_t* data, size_t size);
+
+private:
+  BipBufferHeaderV2() = default;
+
+  // Shared implementation of Create() and CreateMirrored()
+  static BipBufferHeaderV2* Construct(
+    uint8_t* data, size_t size, size_t bufferOffset, uint32_t flags);
+};
+
+} // namespace mvi
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <system_error>
+
+namespace mvi {
+
+// Adapters moving data between a bip buffer and a file descriptor without an
+// intermediate copy. They follow the conventions of read(2) and write(2): an
+// interrupted call is retried, and a descriptor in non-blocking mode that is
+// not ready reports EAGAIN (std::errc::resource_unavailable_try_again) without
+// changing the buffer. Not supported on Windows.
+
+/**
+ * Writes all readable bytes of a bip buffer to a file descriptor, such as a
+ * pipe or a file, with a single writev() covering both segments returned by
+ * BipBufferReader::readAll(), and advances the reader by the number of bytes
+ * written.
+ *
+ * @param fd the file descriptor to write to
+ * @param reader the reader to drain
+ * @param bytes set to the number of bytes written, zero if nothing was readable
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> DrainToFd(int fd, BipBufferReader& reader, size_t& bytes);
+
+/**
+ * Sends all readable bytes of a bip buffer to a socket with a single sendmsg(),
+ * see DrainToFd(). A closed peer is reported as EPIPE instead of raising
+ * SIGPIPE where MSG_NOSIGNAL is available.
+ *
+ * @param socket a connected stream socket
+ * @param reader the reader to drain
+ * @param bytes set to the number of bytes sent, zero if nothing was readable
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> DrainToSocket(int socket, BipBufferReader& reader, size_t& bytes);
+
+/**
+ * Reads up to `maxLength` bytes from a file descriptor directly into a
+ * reservation from BipBufferWriter::reserveAtMost(), and commits the bytes
+ * actually read. Fails with ENOBUFS if the buffer is full.
+ *
+ * @param fd the file descriptor to read from
+ * @param writer the writer to fill
+ * @param maxLength the maximum number of bytes to read
+ * @param bytes set to the number of bytes read, zero on end of file
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> FillFromFd(
+  int fd, BipBufferWriter& writer, size_t maxLength, size_t& bytes);
+
+/**
+ * Receives up to `maxLength` bytes from a socket with recv() directly into the
+ * buffer, see FillFromFd().
+ *
+ * @param socket a connected stream socket
+ * @param writer the writer to fill
+ * @param maxLength the maximum number of bytes to receive
+ * @param bytes set to the number of bytes received, zero once the peer has shut down
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> FillFromSocket(
+  int socket, BipBufferWriter& writer, size_t maxLength, size_t& bytes);
+
+} // namespace mvi
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "BipBufferHeaderV2.hpp"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * A header structure for a lossy circular buffer, where the writer never waits
+ * for readers and overwrites the oldest records instead. Positions increase
+ * monotonically and are mapped into the buffer modulo `bufferSize`.
+ *
+ * The buffer holds a sequence of records. Each record starts with a descriptor
+ * word holding its span and payload length, followed by a word holding its
+ * 64-bit message sequence number, then the payload padded to RECORD_ALIGNMENT
+ * bytes. A record that does not fit before the end of the buffer is preceded by
+ * a padding record, which only has a descriptor word.
+ *
+ * `tail` is the position of the oldest record that is still intact. Before
+ * overwriting records the writer advances `tail` past them, and readers check
+ * `tail` after copying a record, in the manner of a seqlock, to detect that
+ * they were lapped while copying. Readers never write to the header, so any
+ * number of them can follow the same buffer.
+ */
+struct alignas(CACHE_LINE_SIZE) BipBufferLossyHeader {
+  static constexpr uint32_t MAGIC = 0x534C4221; // "!BLS" in little-endian byte order
+  static constexpr uint32_t VERSION = 1;
+
+  static constexpr size_t RECORD_HEADER_SIZE = 2 * sizeof(uint64_t);
+  static constexpr size_t RECORD_ALIGNMENT = sizeof(uint64_t);
+  static constexpr uint64_t PADDING_FLAG = uint64_t(1) << 63;
+  static constexpr size_t MAX_BUFFER_SIZE = 0x7FFFFFF8; // Record spans are stored in 31 bits
+
+  // Metadata, written once by Create() and read-only afterwards
+  uint32_t magic; // Always MAGIC
+  uint32_t version; // Layout version, always VERSION
+  uint64_t bufferSize; // Size of the buffer, a multiple of RECORD_ALIGNMENT
+
+  // Producer cache line, only written by the writer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head; // Position after the last record
+  std::atomic<uint64_t> tail; // Position of the oldest intact record
+  std::atomic<uint64_t> sequence; // Sequence number of the next record
+
+  /// Returns the buffer as an array of words. Both sides access the buffer
+  /// through atomic words, since a reader may copy a record while the writer
+  /// overwrites it.
+  std::atomic<uint64_t>* words();
+
+  /// Encodes the descriptor word of a record spanning `span` bytes and holding
+  /// `length` payload bytes, or of a padding record
+  static constexpr uint64_t Descriptor(size_t span, size_t length, bool padding) {
+    return (uint64_t(span) << 32) | uint64_t(length) | (padding ? PADDING_FLAG : 0);
+  }
+
+  /// Returns the number of bytes spanned by a record, given its descriptor word
+  static constexpr size_t RecordSpan(uint64_t descriptor) {
+    return size_t((descriptor & ~PADDING_FLAG) >> 32);
+  }
+
+  /// Returns the payload length of a record, given its descriptor word
+  static constexpr size_t RecordLength(uint64_t descriptor) {
+    return size_t(descriptor & 0xFFFFFFFF);
+  }
+
+  /**
+   * Instantiate a BipBufferLossyHeader from an existing block of memory.
+   *
+   * @param data Pointer to allocated memory where the header will be constructed.
+   *   Must be aligned to CACHE_LINE_SIZE.
+   * @param size Size of the allocated memory block. The memory must be large
+   *   enough to hold the full header structure (128 bytes), plus at least two
+   *   record headers for the buffer. The buffer size is rounded down to a
+   *   multiple of RECORD_ALIGNMENT and capped at MAX_BUFFER_SIZE.
+   * @return Pointer to the initialized BipBufferLossyHeader instance or nullptr
+   *   if the parameters are invalid.
+   */
+  static BipBufferLossyHeader* Create(uint8_t* data, size_t size);
+
+  /**
+   * Attach to a BipBufferLossyHeader previously initialized with Create(), for
+   * example by another process sharing the same memory.
+   *
+   * @return Pointer to the existing BipBufferLossyHeader or nullptr if the
+   *   memory does not hold a valid header of this version, or is too small for
+   *   the buffer size recorded in it.
+   */
+  static BipBufferLossyHeader* Attach(uint8_t* data, size_t size);
+
+private:
+  BipBufferLossyHeader() = default;
+};
+
+} // namespace mvi
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "BipBufferLossyHeader.hpp"
+
+#include <cstddef>
+#include <optional>
+
+namespace mvi {
+
+/**
+ * A BipBufferLossyReader reads messages from a lossy circular buffer prefixed
+ * with a BipBufferLossyHeader. Readers only load from the header, so any
+ * number of them can follow the same buffer, and none of them can slow down
+ * the writer. A reader that falls behind by more than the buffer size skips
+ * forward to the oldest intact record and accounts for what it lost.
+ */
+class BipBufferLossyReader {
+public:
+  /// Construct a BipBufferLossyReader starting at the oldest intact record in the buffer
+  explicit BipBufferLossyReader(BipBufferLossyHeader& layout);
+
+  ~BipBufferLossyReader() = default;
+
+  BipBufferLossyReader(const BipBufferLossyReader&) = delete;
+  BipBufferLossyReader& operator=(const BipBufferLossyReader&) = delete;
+  BipBufferLossyReader(BipBufferLossyReader&&) = default;
+  BipBufferLossyReader& operator=(BipBufferLossyReader&&) = delete;
+
+  /**
+   * Copies the next message into `data` and consumes it. Messages longer than
+   * `capacity` are truncated to `capacity` bytes.
+   *
+   * @return The full length of the message, or an empty optional if no new
+   *   message is available.
+   */
+  std::optional<size_t> read(void* data, size_t capacity);
+
+  /// Returns the sequence number of the last message returned by read()
+  uint64_t sequence() const { return sequence_; }
+
+  /// Returns the total number of messages that were overwritten before this reader got to them
+  uint64_t lostMessages() const { return lostMessages_; }
+
+  /// Returns the total number of buffer bytes, including record headers and
+  /// padding, that were overwritten before this reader got to them
+  uint64_t lostBytes() const { return lostBytes_; }
+
+private:
+  BipBufferLossyHeader& layout_;
+  const std::atomic<uint64_t>* words_;
+  size_t bufferSize_;
+  uint64_t position_; // Read position, owned by this reader
+  uint64_t sequence_ = 0; // Sequence number of the last message read
+  bool started_ = false; // Has a message been read, making `sequence_` valid
+  uint64_t lostMessages_ = 0;
+  uint64_t lostBytes_ = 0;
+
+  // Skips forward to `position`, counting the skipped bytes as lost
+  void skipTo(uint64_t position);
+};
+
+} // namespace mvi
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "BipBufferLossyHeader.hpp"
+
+#include <cstddef>
+
+namespace mvi {
+
+/**
+ * A BipBufferLossyWriter is the exclusive writer of a lossy circular buffer
+ * prefixed with a BipBufferLossyHeader. Writes never wait for readers: when
+ * the buffer is full the oldest records are overwritten, and readers that fall
+ * behind detect the loss when they read.
+ *
+ * Messages are copied into the buffer rather than written through a
+ * reservation, since a lapped reader may be copying the same bytes
+ * concurrently. The copy uses relaxed atomic word stores, which keeps this
+ * well-defined.
+ */
+class BipBufferLossyWriter {
+public:
+  /// Construct a BipBufferLossyWriter as the exclusive writer for a lossy buffer
+  explicit BipBufferLossyWriter(BipBufferLossyHeader& layout);
+
+  ~BipBufferLossyWriter() = default;
+
+  BipBufferLossyWriter(const BipBufferLossyWriter&) = delete;
+  BipBufferLossyWriter& operator=(const BipBufferLossyWriter&) = delete;
+  BipBufferLossyWriter(BipBufferLossyWriter&&) = default;
+  BipBufferLossyWriter& operator=(BipBufferLossyWriter&&) = delete;
+
+  /**
+   * Writes a message to the buffer, overwriting the oldest records if needed.
+   *
+   * @return True if the message was written, false only if the message and its
+   *   record header do not fit in the buffer at all.
+   */
+  bool write(const void* data, size_t length);
+
+  /// Returns the sequence number that the next message will be stamped with
+  uint64_t sequence() const { return sequence_; }
+
+private:
+  BipBufferLossyHeader& layout_;
+  std::atomic<uint64_t>* words_;
+  size_t bufferSize_;
+  uint64_t head_; // Head position, owned by this writer
+  uint64_t tail_; // Tail position, owned by this writer
+  uint64_t sequence_; // Sequence number of the next record
+
+  // Advances the tail past every record that overlaps the space up to `end`,
+  // given that the next record starts at `start`
+  void evict(uint64_t start, uint64_t end);
+};
+
+} // namespace mvi
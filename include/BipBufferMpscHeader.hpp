@@ -0,0 +1,104 @@
+#pragma once
+
+#include "BipBufferHeaderV2.hpp"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * A header structure for a multi-producer, single-consumer bip buffer. Any
+ * number of BipBufferMpscWriter instances, in one or more processes, claim
+ * space by atomically advancing `claim`, while a single BipBufferMpscReader
+ * consumes records and advances `read`. Both positions increase monotonically
+ * and are mapped into the buffer modulo `bufferSize`, which rules out ABA
+ * problems when a position wraps around.
+ *
+ * The buffer holds a sequence of records, each a RECORD_HEADER_SIZE header word
+ * followed by the payload and padded to RECORD_ALIGNMENT bytes. A header word of
+ * zero marks a record that has been claimed but not committed yet; a writer
+ * commits a record by storing its header word, so records can be committed out
+ * of order and the reader never sees a partially written one. When a record
+ * does not fit before the end of the buffer, the rest of the buffer is filled
+ * with a padding record and the record is placed at the start, so every record
+ * is contiguous.
+ */
+struct alignas(CACHE_LINE_SIZE) BipBufferMpscHeader {
+  static constexpr uint32_t MAGIC = 0x4D504221; // "!BPM" in little-endian byte order
+  static constexpr uint32_t VERSION = 1;
+
+  static constexpr size_t RECORD_HEADER_SIZE = sizeof(uint64_t);
+  static constexpr size_t RECORD_ALIGNMENT = sizeof(uint64_t);
+  static constexpr uint64_t PADDING_FLAG = uint64_t(1) << 63;
+  static constexpr size_t MAX_BUFFER_SIZE = 0x7FFFFFF8; // Record spans are stored in 31 bits
+
+  // Metadata, written once by Create() and read-only afterwards
+  uint32_t magic; // Always MAGIC
+  uint32_t version; // Layout version, always VERSION
+  uint64_t bufferSize; // Size of the buffer, a multiple of RECORD_ALIGNMENT
+
+  // Producer cache line, shared by all writers
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> claim; // Total bytes claimed by writers
+
+  // Consumer cache line, only written by the reader
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> read; // Total bytes consumed by the reader
+
+  /// Returns a const pointer to the beginning of the circular buffer
+  const uint8_t* buffer() const;
+
+  /// Returns a pointer to the beginning of the circular buffer
+  uint8_t* buffer();
+
+  /// Returns the header word of the record starting at the given buffer offset
+  std::atomic<uint64_t>& record(size_t offset);
+
+  /// Encodes the header word of a committed record spanning `span` bytes and
+  /// holding `length` payload bytes, or of a padding record
+  static constexpr uint64_t RecordHeader(size_t span, size_t length, bool padding) {
+    return (uint64_t(span) << 32) | uint64_t(length) | (padding ? PADDING_FLAG : 0);
+  }
+
+  /// Returns the number of bytes spanned by a record, given its header word
+  static constexpr size_t RecordSpan(uint64_t header) {
+    return size_t((header & ~PADDING_FLAG) >> 32);
+  }
+
+  /// Returns the payload length of a record, given its header word
+  static constexpr size_t RecordLength(uint64_t header) { return size_t(header & 0xFFFFFFFF); }
+
+  /**
+   * Instantiate a BipBufferMpscHeader from an existing block of memory. The
+   * buffer is zeroed, which is the state of free space the reader relies on.
+   *
+   * @param data Pointer to allocated memory where the header will be constructed.
+   *   Must be aligned to CACHE_LINE_SIZE.
+   * @param size Size of the allocated memory block. The memory must be large
+   *   enough to hold the full header structure (192 bytes), plus at least two
+   *   records of RECORD_ALIGNMENT bytes for the buffer. The buffer size is
+   *   rounded down to a multiple of RECORD_ALIGNMENT and capped at MAX_BUFFER_SIZE.
+   * @return Pointer to the initialized BipBufferMpscHeader instance or nullptr
+   *   if the parameters are invalid.
+   */
+  static BipBufferMpscHeader* Create(uint8_t* data, size_t size);
+
+  /**
+   * Attach to a BipBufferMpscHeader previously initialized with Create(), for
+   * example by another process sharing the same memory.
+   *
+   * @return Pointer to the existing BipBufferMpscHeader or nullptr if the
+   *   memory does not hold a valid header of this version, or is too small for
+   *   the buffer size recorded in it.
+   */
+  static BipBufferMpscHeader* Attach(uint8_t* data, size_t size);
+
+private:
+  BipBufferMpscHeader() = default;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+  "64-bit atomics must be lock-free to be shared between processes");
+
+} // namespace mvi
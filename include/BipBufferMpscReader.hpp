@@ -0,0 +1,54 @@
+#pragma once
+
+#include "BipBufferMpscHeader.hpp"
+
+#include <optional>
+#include <string_view>
+
+namespace mvi {
+
+/**
+ * A BipBufferMpscReader is the single reader of a multi-producer bip buffer
+ * prefixed with a BipBufferMpscHeader. It returns committed records one at a
+ * time, in the order they were reserved, and stops at the first record that
+ * has been reserved but not committed yet.
+ */
+class BipBufferMpscReader {
+public:
+  /// Construct a BipBufferMpscReader as the exclusive reader for a multi-producer bip buffer
+  explicit BipBufferMpscReader(BipBufferMpscHeader& layout);
+
+  ~BipBufferMpscReader() = default;
+
+  BipBufferMpscReader(const BipBufferMpscReader&) = delete;
+  BipBufferMpscReader& operator=(const BipBufferMpscReader&) = delete;
+  BipBufferMpscReader(BipBufferMpscReader&&) = default;
+  BipBufferMpscReader& operator=(BipBufferMpscReader&&) = delete;
+
+  /// Returns the total number of bytes consumed from the buffer
+  size_t position() const;
+
+  /**
+   * Peeks at the payload of the next committed record without consuming it.
+   * Padding records are skipped. Returns an empty optional if the next record
+   * has not been committed yet; a committed record may have an empty payload.
+   */
+  std::optional<std::string_view> read();
+
+  /**
+   * Consumes the record returned by the last call to read(), making its space
+   * available to the writers. Returns false if there is no such record.
+   */
+  [[nodiscard]] bool advance();
+
+private:
+  BipBufferMpscHeader& layout_;
+  size_t bufferSize_;
+  uint64_t cachedRead_; // Read position, owned by this reader
+  size_t peekedSpan_ = 0; // Span of the record returned by read(), zero if none
+
+  // Zeroes the record at the read position and publishes the new read position
+  void release(size_t offset, size_t span);
+};
+
+} // namespace mvi
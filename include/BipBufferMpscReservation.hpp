@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * A move-only handle to a record reserved in a multi-producer bip buffer by
+ * BipBufferMpscWriter::reserve(). The reservation is committed when it is
+ * destroyed or explicitly committed, by storing the record header word that
+ * makes it visible to the reader. It does not refer back to the writer, so it
+ * can outlive the writer that created it. A default-constructed or moved-from
+ * reservation is empty and evaluates to false.
+ */
+class BipBufferMpscReservation {
+public:
+  /// Construct an empty reservation that holds no space and commits nothing
+  BipBufferMpscReservation() = default;
+
+  /**
+   * Construct a reservation for a record in a multi-producer bip buffer.
+   *
+   * @param record Header word of the reserved record, followed by its payload.
+   * @param span Number of bytes spanned by the record, including the header.
+   * @param length Number of payload bytes reserved.
+   */
+  BipBufferMpscReservation(std::atomic<uint64_t>& record, size_t span, size_t length);
+
+  /// The reservation is committed on destruction
+  ~BipBufferMpscReservation();
+
+  // No copying allowed, a reservation must only be committed once
+  BipBufferMpscReservation(const BipBufferMpscReservation&) = delete;
+  BipBufferMpscReservation& operator=(const BipBufferMpscReservation&) = delete;
+
+  /// Take over another reservation, leaving it empty
+  BipBufferMpscReservation(BipBufferMpscReservation&& other) noexcept;
+
+  /// Commit the currently held reservation, if any, then take over another one
+  BipBufferMpscReservation& operator=(BipBufferMpscReservation&& other) noexcept;
+
+  /// Returns true if this object holds a reservation
+  explicit operator bool() const { return record_ != nullptr; }
+
+  /// Access the reserved payload for writing
+  uint8_t* data();
+
+  /// Returns the size of the reserved payload
+  size_t size() const;
+
+  /**
+   * Truncate the reservation to a smaller size. The space spanned by the record
+   * in the buffer is not reduced, since other writers may already have
+   * reserved the space that follows it.
+   *
+   * @param newSize The new size to truncate the reservation to. Must be <= the
+   *   current reservation size.
+   * @return True if truncation succeeded, false if newSize is invalid.
+   */
+  [[nodiscard]] bool truncate(size_t newSize);
+
+  /// Cancel the reservation. Its space is committed as padding, which the
+  /// reader skips, because the records that follow it may already be in use.
+  void cancel();
+
+  /// Commit the reservation immediately instead of on destruction, leaving
+  /// this object empty
+  void commit();
+
+private:
+  std::atomic<uint64_t>* record_ = nullptr; // Header word of the record, null if empty
+  size_t span_ = 0; // Bytes spanned by the record, including the header
+  size_t length_ = 0; // Length of the reserved payload
+  bool canceled_ = false; // Commit the record as padding
+};
+
+} // namespace mvi
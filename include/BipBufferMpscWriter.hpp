@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BipBufferMpscHeader.hpp"
+#include "BipBufferMpscReservation.hpp"
+
+#include <cstddef>
+
+namespace mvi {
+
+/**
+ * A BipBufferMpscWriter writes records into a multi-producer bip buffer
+ * prefixed with a BipBufferMpscHeader. Unlike BipBufferWriter it is not the
+ * exclusive writer: space is claimed with a compare-and-swap on the shared
+ * `claim` position, so any number of writers in any number of threads or
+ * processes can reserve and commit records concurrently without a lock. A
+ * single writer object holds no mutable state and may also be shared between
+ * threads.
+ */
+class BipBufferMpscWriter {
+public:
+  /// Construct a BipBufferMpscWriter as one of the writers for a multi-producer bip buffer
+  explicit BipBufferMpscWriter(BipBufferMpscHeader& layout);
+
+  ~BipBufferMpscWriter() = default;
+
+  BipBufferMpscWriter(const BipBufferMpscWriter&) = delete;
+  BipBufferMpscWriter& operator=(const BipBufferMpscWriter&) = delete;
+  BipBufferMpscWriter(BipBufferMpscWriter&&) = default;
+  BipBufferMpscWriter& operator=(BipBufferMpscWriter&&) = delete;
+
+  /**
+   * Tries to reserve a contiguous record in the buffer. If successful, returns
+   * a reservation for it. If not enough space is available, an empty
+   * reservation is returned. No memory is allocated in either case.
+   *
+   * Records are delivered to the reader in the order they were reserved. A
+   * record that has been reserved but not committed holds back the records
+   * reserved after it, so reservations should be committed promptly.
+   *
+   * @param length The number of payload bytes to reserve.
+   * @return A BipBufferMpscReservation that evaluates to true if space was
+   *   reserved, false otherwise.
+   */
+  [[nodiscard]] BipBufferMpscReservation reserve(size_t length);
+
+private:
+  BipBufferMpscHeader& layout_;
+  size_t bufferSize_;
+};
+
+} // namespace mvi
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <system_error>
+
+namespace mvi {
+
+/**
+ * A notification channel for a bip buffer, backed by a non-blocking eventfd on
+ * Linux. The file descriptor becomes readable when the writer signals it, so
+ * a reader can register the notifiers of many buffers with a single epoll set
+ * and only read from the buffers that have data. The eventfd can be created
+ * in-process, or created by one process and passed to its peer over a Unix
+ * domain socket with SendFileDescriptor() and adopted on the other end.
+ *
+ * See BipBufferWriter::setNotifier() and BipBufferReader::arm().
+ */
+class BipBufferNotifier {
+public:
+  /// Construct an empty notifier without a file descriptor
+  BipBufferNotifier() = default;
+
+  /// Close the file descriptor if it is still open on destruction
+  ~BipBufferNotifier();
+
+  // No copy or assignment
+  BipBufferNotifier(const BipBufferNotifier&) = delete;
+  BipBufferNotifier& operator=(const BipBufferNotifier&) = delete;
+
+  // Move semantics are supported
+  BipBufferNotifier(BipBufferNotifier&& other) noexcept;
+  BipBufferNotifier& operator=(BipBufferNotifier&& other) noexcept;
+
+  /**
+   * Create a new eventfd for this notifier, closing any previous one.
+   *
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> create();
+
+  /**
+   * Take ownership of an existing eventfd, for example one received from the
+   * peer process with ReceiveFileDescriptor(). Any previous one is closed.
+   *
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> adopt(int fd);
+
+  /// Returns the file descriptor to poll for readability, or -1 if there is none
+  int fd() const { return fd_; }
+
+  /// Makes the file descriptor readable. Does nothing without a file descriptor
+  void signal() const;
+
+  /// Consumes pending signals so the file descriptor is no longer readable.
+  /// Returns the number of signals since the last call
+  uint64_t drain() const;
+
+  /// Closes the file descriptor
+  std::optional<std::system_error> close();
+
+private:
+  int fd_ = -1;
+};
+
+} // namespace mvi
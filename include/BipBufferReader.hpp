@@ -1,21 +1,39 @@
 #pragma once
 
+#include "BipBufferBroadcastHeader.hpp"
+#include "BipBufferDurability.hpp"
 #include "BipBufferHeader.hpp"
+#include "BipBufferHeaderV2.hpp"
+#include "BipBufferWait.hpp"
 
+#include <array>
+#include <chrono>
 #include <string_view>
 
 namespace mvi {
 
 /**
  * A BipBufferReader is used to read data from a bipartite circular buffer
- * prefixed with a BipBufferHeader. It provides methods to read data from the
- * buffer and advance the read position.
+ * prefixed with a BipBufferHeader, BipBufferHeaderV2 or
+ * BipBufferBroadcastHeader. It provides methods to read data from the buffer
+ * and advance the read position.
  */
 class BipBufferReader {
 public:
   /// Construct a BipBufferReader as the exclusive reader for a bip buffer
   explicit BipBufferReader(BipBufferHeader& layout);
 
+  /// Construct a BipBufferReader as the exclusive reader for a bip buffer using the v2 layout
+  explicit BipBufferReader(BipBufferHeaderV2& layout);
+
+  /**
+   * Construct a BipBufferReader as one of the readers of a broadcast bip
+   * buffer, using a slot claimed with BipBufferBroadcastHeader::registerReader().
+   * Until the writer admits the reader no data is available. The slot must be
+   * unregistered after the reader is destroyed.
+   */
+  BipBufferReader(BipBufferBroadcastHeader& layout, size_t slot);
+
   ~BipBufferReader() = default;
 
   BipBufferReader(const BipBufferReader&) = delete;
@@ -34,18 +52,94 @@ public:
    */
   std::string_view read();
 
+  /**
+   * Peeks at the next available bytes in the buffer, waiting for the writer
+   * to publish data if none is available. With WaitStrategy::SpinFutex the
+   * reader sleeps in the kernel until the writer publishes, which requires a
+   * BipBufferHeaderV2 created with FLAG_WAKEUPS; otherwise it yields instead.
+   *
+   * @return The available bytes, or an empty string_view if the timeout expired.
+   */
+  std::string_view read(WaitStrategy strategy, std::chrono::nanoseconds timeout);
+
+  /**
+   * Asks the writer to signal its BipBufferNotifier the next time it
+   * publishes. Call this when read() returns no data, before waiting for the
+   * notifier's file descriptor to become readable, for example with epoll.
+   * Requires a BipBufferHeaderV2 created with FLAG_WAKEUPS.
+   *
+   * @return True if the reader may wait for the notification. False if data
+   *   was published in the meantime and should be read first, or if wakeups
+   *   are not enabled for this buffer.
+   */
+  [[nodiscard]] bool arm();
+
+  /**
+   * Peeks at all available bytes in the buffer without advancing the read
+   * position. When the readable data wraps around the end of the buffer it is
+   * returned as two segments, the tail of the buffer followed by the head;
+   * otherwise, and always for a mirrored buffer, the second segment is empty.
+   * Both segments can be consumed with a single call to advance() using the sum
+   * of their sizes.
+   */
+  std::array<std::string_view, 2> readAll();
+
   /**
    * Advances the read position by the given number of bytes. Returns true if
    * the read position was advanced, false if there were insufficient bytes
-   * available and the read position was not changed.
+   * available and the read position was not changed. The count may span both
+   * segments returned by readAll().
    */
   [[nodiscard]] bool advance(size_t count);
 
+  /**
+   * Flushes the read position to the file backing the buffer after every
+   * advance(), see BipBufferWriter::setDurability(). A reader restarted after
+   * a crash resumes from the persisted position. Without this, the position is
+   * only persisted along with the writer's flushes, and data consumed since
+   * then is read again after a crash.
+   */
+  void setDurability(Durability durability) { durability_ = durability; }
+
+  /**
+   * Returns the number of bytes, counted from the start of the header, that
+   * the reader's mapping must cover before it acknowledges a growth request
+   * of the writer, or zero if there is no pending request. See
+   * BipBufferWriter::grow().
+   */
+  size_t pendingGrowth() const;
+
+  /**
+   * Acknowledges the pending growth request, allowing the writer to use the
+   * larger buffer. Call this only once the reader's mapping covers the size
+   * returned by pendingGrowth(), for example after SharedMemory::resize().
+   */
+  void acknowledgeGrowth();
+
 private:
-  BipBufferHeader& layout_;
+  std::atomic<uint64_t>& read_;
+  std::atomic<uint64_t>& write_;
+  std::atomic<uint64_t>& last_;
+  const uint8_t* buffer_;
   size_t cachedRead_;
   size_t cachedWrite_;
   size_t cachedLast_;
+  bool joining_ = false; // Waiting for the writer to admit this broadcast reader
+  size_t mirrorSize_ = 0; // Buffer size if the buffer is followed by a mirror, else zero
+  Durability durability_ = Durability::None;
+  BipBufferHeaderV2* growable_ = nullptr; // Header of a buffer that can grow, else null
+  std::atomic<uint32_t>* readerWaiting_ = nullptr; // Null unless wakeups are enabled
+  std::atomic<uint32_t>* writerWaiting_ = nullptr; // Null unless wakeups are enabled
+  bool lightWakeFence_ = false; // WakeFence() is a compiler barrier, see PrepareWakeFences()
+  BipBufferStatistics* statistics_ = nullptr; // Null unless counters are enabled
+
+  // Picks up the position assigned by the writer to a joining reader. Returns
+  // false if the reader has not been admitted yet.
+  bool join();
+
+  // Returns the number of bytes between the cached read and write positions
+  // of a mirrored buffer
+  size_t mirroredAvailable() const;
 };
 
 } // namespace mvi
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BipBufferHeaderV2.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * Counters describing the traffic through a bip buffer, kept directly after a
+ * BipBufferHeaderV2 created with FLAG_STATISTICS. BipBufferWriter and
+ * BipBufferReader update them as they go.
+ *
+ * Every counter has a single writer. The counters owned by the writer and the
+ * counters owned by the reader are on separate cache lines. Each side updates
+ * its own line with relaxed loads and stores, without locked instructions, so
+ * counting adds no traffic between the two sides. Any process mapping the
+ * buffer can sample the counters at any time with load(). Each counter only
+ * grows, but a snapshot is not taken atomically across counters.
+ *
+ * The writer only knows how far the reader has got when it reloads the read
+ * position, so `highWaterMark` is sampled at the first commit after each
+ * reload. That happens at least once per pass through the buffer and on every
+ * reservation that finds too little space, so a buffer that comes near full
+ * is always recorded, while a reader that keeps up keeps the mark low.
+ */
+struct alignas(CACHE_LINE_SIZE) BipBufferStatistics {
+  /// A snapshot of the counters
+  struct Counters {
+    uint64_t bytesCommitted;
+    uint64_t messagesCommitted;
+    uint64_t reserveFailures;
+    uint64_t wraps;
+    uint64_t wastedBytes;
+    uint64_t highWaterMark;
+    uint64_t bytesConsumed;
+    uint64_t advances;
+  };
+
+  // Writer cache line, only written by the writer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> bytesCommitted; // Bytes of committed reservations
+  std::atomic<uint64_t> messagesCommitted; // Committed reservations
+  std::atomic<uint64_t> reserveFailures; // Reservations that found too little space, incl. retries
+  std::atomic<uint64_t> wraps; // Reservations that wrapped around to the start of the buffer
+  std::atomic<uint64_t> wastedBytes; // Bytes left unused at the end of the buffer by wraps
+  std::atomic<uint64_t> highWaterMark; // Highest occupancy in bytes, see below
+
+  // Reader cache line, only written by the reader
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> bytesConsumed; // Bytes passed to advance()
+  std::atomic<uint64_t> advances; // Successful advance() calls
+
+  /// Returns a snapshot of the counters, safe to call from any thread or process
+  Counters load() const;
+
+  /// Adds to a counter, which must only be written by the calling side
+  static void Add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  /// Raises a counter to `value` if it is lower, which must only be written by the calling side
+  static void Raise(std::atomic<uint64_t>& counter, uint64_t value) {
+    if (value > counter.load(std::memory_order_relaxed)) {
+      counter.store(value, std::memory_order_relaxed);
+    }
+  }
+};
+
+// Other processes read the counters directly from shared memory
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "statistics counters must be lock-free");
+
+} // namespace mvi
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mvi {
+
+/// How a blocking BipBufferWriter::reserve() or BipBufferReader::read() waits
+/// for the other side
+enum class WaitStrategy {
+  BusySpin, // Retry immediately, lowest latency, burns a core
+  SpinPause, // Retry with a CPU pause hint between attempts
+  SpinFutex, // Pause for a while, then sleep in the kernel until woken by the other side
+};
+
+/// Number of attempts SpinFutex makes with a CPU pause hint before sleeping
+constexpr uint32_t WAIT_SPIN_COUNT = 1024;
+
+/// Hints to the CPU that the caller is in a spin loop
+void CpuRelax();
+
+/**
+ * Blocks while `word` holds `expected`, until woken by FutexWake() or the
+ * timeout expires. May return spuriously. The word may be in memory shared
+ * between processes. On platforms without futexes this sleeps briefly instead.
+ */
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout);
+
+/// Wakes all threads blocked in FutexWait() on `word`
+void FutexWake(std::atomic<uint32_t>& word);
+
+/**
+ * Prepares the calling process for the wakeup handshake, registering it with
+ * membarrier() where that is available. Returns true if SleepFence() uses
+ * membarrier(), in which case WakeFence() only needs to be a compiler barrier.
+ * Both sides of a buffer must call this before they publish positions.
+ */
+bool PrepareWakeFences();
+
+/// Issued by the waking side between publishing its position and loading the
+/// other side's wait word. `light` is the result of PrepareWakeFences()
+inline void WakeFence(bool light) {
+  if (light) {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } else {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+/// Issued by the side going to sleep between storing its wait word and
+/// checking the other side's position once more. Pairs with WakeFence()
+void SleepFence();
+
+} // namespace mvi
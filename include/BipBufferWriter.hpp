@@ -1,55 +1,235 @@
 #pragma once
 
+#include "BipBufferBroadcastHeader.hpp"
+#include "BipBufferDurability.hpp"
 #include "BipBufferHeader.hpp"
+#include "BipBufferHeaderV2.hpp"
+#include "BipBufferNotifier.hpp"
+#include "BipBufferWait.hpp"
 #include "BipBufferWriterReservation.hpp"
 
+#include <chrono>
 #include <cstddef>
-#include <memory>
 
 namespace mvi {
 
 /**
  * A BipBufferWriter is used to write data into a bipartite circular buffer
- * prefixed with a BipBufferHeader. It provides a method to reserve a contiguous
- * block of memory in the buffer, represented as a BipBufferWriterReservation.
- * The reservation is committed when the unique_ptr is reset or destroyed.
+ * prefixed with a BipBufferHeader, BipBufferHeaderV2 or
+ * BipBufferBroadcastHeader. It provides a method to
+ * reserve a contiguous block of memory in the buffer, represented as a
+ * BipBufferWriterReservation. The reservation is committed when it is
+ * destroyed or explicitly committed.
  */
 class BipBufferWriter {
 public:
-  /// Construct a BipBufferWriter as the exclusive writer for a bip buffer
-  explicit BipBufferWriter(BipBufferHeader& layout) : layout_(layout) {}
+  /**
+   * Controls when committed reservations are published to the reader. By
+   * default every commit is published immediately. With batching, commits are
+   * applied locally and the shared `write` position is published once any of
+   * the enabled limits is reached, or when flush() is called. A limit of zero
+   * disables it.
+   */
+  struct BatchPolicy {
+    size_t maxMessages; // Publish after this many unpublished commits
+    size_t maxBytes; // Publish after this many unpublished bytes
+    std::chrono::nanoseconds maxLatency; // Publish once the oldest unpublished commit is this old
+  };
+
+  /**
+   * Construct a BipBufferWriter as the exclusive writer for a bip buffer. The
+   * writer keeps its own copy of the write position, so the header's `write`
+   * and `last` fields must not be modified by anyone else while it exists.
+   */
+  explicit BipBufferWriter(BipBufferHeader& layout);
+
+  /// Construct a BipBufferWriter as the exclusive writer for a bip buffer using the v2 layout
+  explicit BipBufferWriter(BipBufferHeaderV2& layout);
 
-  ~BipBufferWriter() = default;
+  /**
+   * Construct a BipBufferWriter as the exclusive writer for a broadcast bip
+   * buffer. Free space is computed against the slowest registered reader, and
+   * joining readers are admitted whenever commits are published.
+   */
+  explicit BipBufferWriter(BipBufferBroadcastHeader& layout);
+
+  /// Publishes any batched commits on destruction
+  ~BipBufferWriter();
 
   BipBufferWriter(const BipBufferWriter&) = delete;
   BipBufferWriter& operator=(const BipBufferWriter&) = delete;
-  BipBufferWriter(BipBufferWriter&&) = default;
+  BipBufferWriter(BipBufferWriter&& other) noexcept;
   BipBufferWriter& operator=(BipBufferWriter&&) = delete;
 
   /**
    * Tries to reserve a contiguous block of memory in the buffer. If successful,
-   * returns a unique_ptr to a reservation. If not enough space is available,
-   * nullptr is returned.
+   * returns a reservation for it. If not enough space is available, an empty
+   * reservation is returned. No memory is allocated in either case.
    *
    * Only one reservation can be active at a time. Attempting to reserve space
    * while a reservation is active will result in undefined behavior. The
-   * reservation is committed when the unique_ptr goes out of scope.
+   * reservation is committed when it goes out of scope.
    *
    * @param length The number of bytes to reserve. If there is not enough
-   *   contiguous space available, nullptr is returned.
-   * @return A BipBufferWriterReservation if space was reserved, nullptr
-   *   otherwise.
+   *   contiguous space available, an empty reservation is returned.
+   * @return A BipBufferWriterReservation that evaluates to true if space was
+   *   reserved, false otherwise.
+   */
+  [[nodiscard]] BipBufferWriterReservation reserve(size_t length);
+
+  /**
+   * Reserves the largest contiguous block of memory available, up to
+   * `maxLength` bytes. Useful when the amount of data is not known in advance,
+   * for example when filling the buffer from a socket, see FillFromFd(). The
+   * reservation can be truncated to the number of bytes actually written.
+   *
+   * @param maxLength The maximum number of bytes to reserve.
+   * @return A BipBufferWriterReservation of between 1 and `maxLength` bytes,
+   *   or an empty reservation if the buffer is full.
+   */
+  [[nodiscard]] BipBufferWriterReservation reserveAtMost(size_t maxLength);
+
+  /**
+   * Reserves a contiguous block of memory in the buffer, waiting for the
+   * reader to free up space if necessary. With WaitStrategy::SpinFutex the
+   * writer sleeps in the kernel until the reader advances, which requires a
+   * BipBufferHeaderV2 created with FLAG_WAKEUPS; otherwise it yields instead.
+   *
+   * @param length The number of bytes to reserve.
+   * @param strategy How to wait while the buffer is full.
+   * @param timeout How long to wait before giving up.
+   * @return A BipBufferWriterReservation that evaluates to true if space was
+   *   reserved, false if the timeout expired.
+   */
+  [[nodiscard]] BipBufferWriterReservation reserve(
+    size_t length, WaitStrategy strategy, std::chrono::nanoseconds timeout);
+
+  /**
+   * Sets the policy for publishing commits to the reader. Any commits batched
+   * under the previous policy are published first.
+   */
+  void setBatchPolicy(const BatchPolicy& policy);
+
+  /**
+   * Sets the notifier that is signaled when commits are published while the
+   * reader is armed, see BipBufferReader::arm(). The reader only arms itself
+   * when it finds the buffer empty, so the notifier is signaled at most once
+   * per empty to non-empty transition. Requires a BipBufferHeaderV2 created
+   * with FLAG_WAKEUPS. The notifier is not owned and must outlive the writer,
+   * or be reset with nullptr.
    */
-  std::unique_ptr<BipBufferWriterReservation> reserve(size_t length);
+  void setNotifier(const BipBufferNotifier* notifier);
+
+  /**
+   * Flushes published commits to the file backing the buffer, for example a
+   * SharedMemory opened with SharedMemory::File(). Every publish first flushes
+   * the newly written bytes, then stores the `write` position and flushes the
+   * header, so a persisted `write` never covers bytes that were not persisted.
+   * Combine with a BatchPolicy to flush per batch instead of per commit. The
+   * reader's position is persisted together with the header, see also
+   * BipBufferReader::setDurability(). Enabling durability flushes the whole
+   * buffer once.
+   */
+  void setDurability(Durability durability);
+
+  /// Returns the first error of a durability flush, if any. Later flushes are still attempted
+  const std::optional<std::system_error>& durabilityError() const { return durabilityError_; }
+
+  /**
+   * Requests growing the buffer to `bufferSize` bytes while it is in use. The
+   * writer's own mapping must already cover the larger buffer, for example
+   * after SharedMemory::resize() on an area opened with Options::reserve. The
+   * writer keeps using the current size until the reader has grown its mapping
+   * and called BipBufferReader::acknowledgeGrowth(), then switches over the
+   * next time it runs out of space. Positions do not move, so data in flight
+   * is not affected.
+   *
+   * @return True if growth was requested. False if the buffer is not a
+   *   non-mirrored BipBufferHeaderV2, `bufferSize` is not larger than the
+   *   current size, or a previous request has not been acknowledged yet.
+   */
+  [[nodiscard]] bool grow(size_t bufferSize);
+
+  /// Returns the size of the buffer currently used by the writer
+  size_t bufferSize() const { return bufferSize_; }
+
+  /// Returns the current batching policy
+  const BatchPolicy& batchPolicy() const { return policy_; }
+
+  /**
+   * Publishes all commits that have not been published yet. With batching
+   * enabled, this should be called when the producer goes idle, since the
+   * latency limit is only checked from reserve() and commits.
+   */
+  void flush();
 
 private:
-  BipBufferHeader& layout_;
+  std::atomic<uint64_t>* read_; // Single reader position, null for a broadcast buffer
+  BipBufferBroadcastHeader* broadcast_; // Reader cursors of a broadcast buffer, else null
+  std::atomic<uint64_t>& write_;
+  std::atomic<uint64_t>& last_;
+  uint8_t* buffer_;
+  size_t bufferSize_;
+  size_t cachedRead_; // Last observed read position, lags behind the reader
+  size_t cachedWrite_; // Write position, owned by this writer
+  size_t cachedLast_; // End of data position, owned by this writer
+  size_t publishedLast_; // Last `last` position stored in the header
+  bool mirrored_ = false; // The buffer is followed by a mirror of itself, `last` is unused
+  BatchPolicy policy_{1, 0, std::chrono::nanoseconds::zero()};
+  size_t pendingMessages_ = 0; // Commits not yet published
+  size_t pendingBytes_ = 0; // Bytes committed but not yet published
+  std::chrono::steady_clock::time_point pendingSince_; // Time of the oldest unpublished commit
+  std::atomic<uint32_t>* readerWaiting_ = nullptr; // Null unless wakeups are enabled
+  std::atomic<uint32_t>* writerWaiting_ = nullptr; // Null unless wakeups are enabled
+  bool lightWakeFence_ = false; // WakeFence() is a compiler barrier, see PrepareWakeFences()
+  const BipBufferNotifier* notifier_ = nullptr; // Signaled when an armed reader has new data
+  const uint8_t* header_; // Start of the layout header, flushed with Durability
+  Durability durability_ = Durability::None;
+  size_t syncedWrite_ = 0; // Write position up to which data has been flushed
+  std::optional<std::system_error> durabilityError_; // First failed flush
+  BipBufferHeaderV2* growable_ = nullptr; // Header of a buffer that can grow, else null
+  bool growing_ = false; // A growth request is waiting for the reader's acknowledgement
+  BipBufferStatistics* statistics_ = nullptr; // Null unless counters are enabled
+  bool readRefreshed_ = true; // `cachedRead_` was reloaded since the last counted commit
 
   friend class BipBufferWriterReservation;
 
-  // Commits previously reserved space: updates the `last` and `write` positions
-  // in the layout header.
+  // Finds space for `length` bytes using the cached positions. Returns false
+  // if there is not enough contiguous space according to `cachedRead_`.
+  bool findSpace(size_t length, size_t& start, bool& wraparound) const;
+
+  // Commits previously reserved space: updates the `last` and `write`
+  // positions, and publishes them to the layout header according to the
+  // batching policy.
   void commit(size_t start, size_t len, bool wraparound);
+
+  // Updates the statistics counters after a commit
+  void countCommit(size_t length, bool wraparound);
+
+  // Returns the size of the largest block findSpace() would find
+  size_t largestSpace() const;
+
+  // Reloads the read position after findSpace() found too little space, and
+  // picks up anything else that may provide more space
+  void refreshRead();
+
+  // Loads the read position that bounds the free space: the reader's position,
+  // or the position of the slowest registered reader of a broadcast buffer
+  size_t loadRead() const;
+
+  // Positions joining readers of a broadcast buffer at the published write position
+  void admitReaders();
+
+  // Stores the locally committed `last` and `write` positions in the header
+  void publish();
+
+  // Switches to the requested buffer size once the reader has acknowledged it
+  void adoptGrowth();
+
+  // Flushes the bytes committed since the last flush, or the header. Errors
+  // are kept in `durabilityError_`
+  void syncData();
+  void syncHeader();
 };
 
 } // namespace mvi
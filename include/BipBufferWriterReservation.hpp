@@ -7,8 +7,17 @@ namespace mvi {
 
 class BipBufferWriter;
 
+/**
+ * A move-only handle to a contiguous block of memory reserved in a BipBuffer.
+ * Reservations are returned by value from BipBufferWriter::reserve() and do
+ * not allocate. A default-constructed or moved-from reservation is empty and
+ * evaluates to false.
+ */
 class BipBufferWriterReservation {
 public:
+  /// Construct an empty reservation that holds no space and commits nothing
+  BipBufferWriterReservation() = default;
+
   /**
    * Construct a BipBufferWriterReservation for a contiguous block of memory in
    * a BipBuffer. The reservation is committed when the reservation object is
@@ -19,11 +28,18 @@ public:
   /// The reservation is committed on destruction
   ~BipBufferWriterReservation();
 
-  // No copying or moving allowed to prevent issues
+  // No copying allowed, a reservation must only be committed once
   BipBufferWriterReservation(const BipBufferWriterReservation&) = delete;
   BipBufferWriterReservation& operator=(const BipBufferWriterReservation&) = delete;
-  BipBufferWriterReservation(BipBufferWriterReservation&&) = delete;
-  BipBufferWriterReservation& operator=(BipBufferWriterReservation&&) = delete;
+
+  /// Take over another reservation, leaving it empty
+  BipBufferWriterReservation(BipBufferWriterReservation&& other) noexcept;
+
+  /// Commit the currently held reservation, if any, then take over another one
+  BipBufferWriterReservation& operator=(BipBufferWriterReservation&& other) noexcept;
+
+  /// Returns true if this object holds a reservation
+  explicit operator bool() const { return writer_ != nullptr; }
 
   /// Access the reserved buffer slice for writing
   uint8_t* data();
@@ -47,11 +63,15 @@ public:
   /// Cancel the reservation by truncating it to zero-length
   void cancel();
 
+  /// Commit the reservation immediately instead of on destruction, leaving
+  /// this object empty
+  void commit();
+
 private:
-  BipBufferWriter& writer_; // Reference to the writer to notify when sending
-  size_t start_; // Start of the reserved buffer slice
-  size_t length_; // Length of the reserved buffer slice
-  bool wraparound_; // Does the reservation wrap around the end of the buffer
+  BipBufferWriter* writer_ = nullptr; // Writer to notify when sending, null if empty
+  size_t start_ = 0; // Start of the reserved buffer slice
+  size_t length_ = 0; // Length of the reserved buffer slice
+  bool wraparound_ = false; // Does the reservation wrap around the end of the buffer
 };
 
 } // namespace mvi
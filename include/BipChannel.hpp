@@ -0,0 +1,118 @@
+#pragma once
+
+#include "BipBufferHeaderV2.hpp"
+#include "SharedMemory.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+
+namespace mvi {
+
+/**
+ * A named bip buffer channel between a producer and a consumer process. The
+ * producer creates the channel with create(), which places a BipBufferHeaderV2
+ * in a named SharedMemory area behind a small control block. Consumers open it
+ * with a single attach() call that needs nothing but the name: the size is
+ * taken from the area, and the control block tells whether the header is fully
+ * initialized and of the expected layout, so a consumer started before or
+ * during the producer's startup waits instead of reading a half-initialized
+ * header.
+ *
+ * The control block also records the process IDs of the producer and the
+ * consumer. They keep a second consumer from attaching, and let each side
+ * detect that its peer has exited without closing the channel, see
+ * producerAlive() and consumerAlive().
+ *
+ * The writer and reader are constructed on header() as usual.
+ */
+class BipChannel {
+public:
+  /// Control block at the start of the area, followed by the BipBufferHeaderV2
+  struct alignas(CACHE_LINE_SIZE) Control {
+    static constexpr uint32_t MAGIC = 0x4e484321; // "!CHN" in little-endian byte order
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t STATE_READY = 1;
+
+    std::atomic<uint32_t> state; // Zero until the producer has initialized everything else
+    uint32_t magic; // Always MAGIC
+    uint32_t version; // Layout version of the control block and header, always VERSION
+    uint32_t headerOffset; // Offset of the BipBufferHeaderV2 from the start of the area
+    std::atomic<uint32_t> producerPid; // Process ID of the producer, zero once it closed
+    std::atomic<uint32_t> consumerPid; // Process ID of the consumer, zero if there is none
+  };
+
+  /// Construct a channel with the given name, see SharedMemory for the naming rules
+  explicit BipChannel(const std::string& name);
+
+  /// Close the channel if it is still open on destruction
+  ~BipChannel();
+
+  // No copy or assignment
+  BipChannel(const BipChannel&) = delete;
+  BipChannel& operator=(const BipChannel&) = delete;
+
+  // Move semantics are supported
+  BipChannel(BipChannel&& other) noexcept;
+  BipChannel& operator=(BipChannel&& other) noexcept;
+
+  /**
+   * Create the channel as its producer, replacing a channel of the same name
+   * whose producer is no longer running. Consumers still attached to a
+   * replaced channel keep their mapping and see producerAlive() return false.
+   *
+   * @param bufferSize minimum size of the buffer in bytes, the area is rounded
+   *   up to whole pages and the buffer uses all of it
+   * @param flags combination of BipBufferHeaderV2 FLAG_ values, except FLAG_MIRRORED
+   * @return std::nullopt if the operation was successful, otherwise a
+   *   std::system_error. Fails with EBUSY if the channel exists and its
+   *   producer is still running
+   */
+  std::optional<std::system_error> create(size_t bufferSize, uint32_t flags = 0);
+
+  /**
+   * Attach to the channel as its consumer, waiting up to `timeout` for the
+   * producer to create it and finish initializing it.
+   *
+   * @param timeout how long to wait for the channel, zero checks once
+   * @return std::nullopt if the operation was successful, otherwise a
+   *   std::system_error. Fails with ETIMEDOUT if the channel is not ready in
+   *   time, EPROTO if the area does not hold a channel of this version, and
+   *   EBUSY if another consumer that is still running is attached
+   */
+  std::optional<std::system_error> attach(
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  /// Returns the header of the open channel, or nullptr if it is not open
+  BipBufferHeaderV2* header() { return header_; }
+
+  /// Returns the control block of the open channel, or nullptr if it is not open
+  const Control* control() const { return control_; }
+
+  /// Returns the shared memory area holding the channel
+  const SharedMemory& memory() const { return memory_; }
+
+  /// Returns true if the producer recorded in the control block is still running
+  bool producerAlive() const;
+
+  /// Returns true if the consumer recorded in the control block is still running
+  bool consumerAlive() const;
+
+  /// Clears this side's process ID from the control block and unmaps the
+  /// channel. The channel is not destroyed, see SharedMemory::Destroy()
+  std::optional<std::system_error> close();
+
+private:
+  SharedMemory memory_;
+  Control* control_ = nullptr;
+  BipBufferHeaderV2* header_ = nullptr;
+  std::atomic<uint32_t>* ownPid_ = nullptr; // The control block's PID field of this side
+
+  // Maps an existing, ready channel and validates its layout
+  std::optional<std::system_error> open();
+};
+
+} // namespace mvi
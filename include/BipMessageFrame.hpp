@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * Messages written by BipMessageWriter are framed by prefixing each payload
+ * with its length in bytes, stored in native byte order. A frame never wraps
+ * around the end of the buffer, since it is written into a single contiguous
+ * reservation.
+ */
+using BipMessageLength = uint32_t;
+
+/// Size of the frame header that precedes each message payload
+constexpr size_t BIP_MESSAGE_HEADER_SIZE = sizeof(BipMessageLength);
+
+} // namespace mvi
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BipBufferReader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace mvi {
+
+/**
+ * A zero-copy view of all complete messages that were readable when it was
+ * returned by BipMessageReader::read(). Iterating yields the payload of each
+ * message in order, as views into the bip buffer that stay valid until the
+ * batch is released.
+ */
+class BipMessageBatch {
+public:
+  /// Input iterator over the message payloads of a batch
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+
+    reference operator*() const { return message_; }
+    pointer operator->() const { return &message_; }
+    Iterator& operator++();
+    bool operator==(const Iterator& other) const {
+      return span_ == other.span_ && offset_ == other.offset_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+  private:
+    friend class BipMessageBatch;
+
+    Iterator(const std::array<std::string_view, 2>* spans, size_t span, size_t offset);
+
+    // Parses the frame at the current position, moving on to the next segment
+    // when the current one is exhausted
+    void parse();
+
+    const std::array<std::string_view, 2>* spans_;
+    size_t span_; // Index of the current segment, 2 for the end iterator
+    size_t offset_; // Offset of the current frame within the segment
+    std::string_view message_; // Payload of the current frame
+  };
+
+  BipMessageBatch() = default;
+
+  explicit BipMessageBatch(const std::array<std::string_view, 2>& spans) : spans_(spans) {}
+
+  Iterator begin() const { return Iterator{&spans_, 0, 0}; }
+  Iterator end() const { return Iterator{&spans_, 2, 0}; }
+
+  /// Returns true if the batch holds no messages
+  bool empty() const { return spans_[0].empty() && spans_[1].empty(); }
+
+  /// Returns the number of bytes in the batch, including the frame headers
+  size_t size() const { return spans_[0].size() + spans_[1].size(); }
+
+private:
+  std::array<std::string_view, 2> spans_;
+};
+
+/**
+ * A BipMessageReader reads the length-prefixed messages written by a
+ * BipMessageWriter through a BipBufferReader. Each call to read() returns every
+ * complete message available across both segments of the buffer, and the whole
+ * batch is then consumed with a single call to release().
+ */
+class BipMessageReader {
+public:
+  /// Construct a BipMessageReader on top of the exclusive reader for a bip buffer
+  explicit BipMessageReader(BipBufferReader& reader) : reader_(reader) {}
+
+  /// Returns a batch of all messages that are currently readable. The batch
+  /// is empty if no new messages are available
+  BipMessageBatch read() { return BipMessageBatch{reader_.readAll()}; }
+
+  /**
+   * Releases all messages in a batch returned by the last call to read(),
+   * allowing the writer to reuse their space. The batch must not be used
+   * afterwards.
+   *
+   * @return True if the messages were released, false if the batch does not
+   *   match the readable data.
+   */
+  [[nodiscard]] bool release(const BipMessageBatch& batch) { return reader_.advance(batch.size()); }
+
+private:
+  BipBufferReader& reader_;
+};
+
+} // namespace mvi
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BipBufferWriterReservation.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mvi {
+
+/**
+ * A move-only handle to the payload of a message being written with a
+ * BipMessageWriter. It wraps a BipBufferWriterReservation that also covers the
+ * frame header, which is filled in with the final payload length when the
+ * message is committed. A default-constructed or moved-from reservation is
+ * empty and evaluates to false.
+ */
+class BipMessageReservation {
+public:
+  /// Construct an empty reservation that holds no space and commits nothing
+  BipMessageReservation() = default;
+
+  /// Construct a message reservation from a reservation that includes room for the frame header
+  explicit BipMessageReservation(BipBufferWriterReservation&& reservation);
+
+  /// The message is committed on destruction
+  ~BipMessageReservation();
+
+  // No copying allowed, a message must only be committed once
+  BipMessageReservation(const BipMessageReservation&) = delete;
+  BipMessageReservation& operator=(const BipMessageReservation&) = delete;
+
+  /// Take over another reservation, leaving it empty
+  BipMessageReservation(BipMessageReservation&& other) noexcept = default;
+
+  /// Commit the currently held message, if any, then take over another one
+  BipMessageReservation& operator=(BipMessageReservation&& other) noexcept;
+
+  /// Returns true if this object holds a reservation
+  explicit operator bool() const { return bool(reservation_); }
+
+  /// Access the reserved payload for writing
+  uint8_t* data();
+
+  /// Returns the size of the reserved payload
+  size_t size() const;
+
+  /**
+   * Truncate the payload to a smaller size, for messages reserved with an
+   * upper bound of their final length.
+   *
+   * @param newSize The new payload size. Must be <= the current payload size.
+   * @return True if truncation succeeded, false if newSize is invalid.
+   */
+  [[nodiscard]] bool truncate(size_t newSize);
+
+  /// Cancel the message, nothing is written to the buffer
+  void cancel();
+
+  /// Write the frame header and commit the message immediately instead of on
+  /// destruction, leaving this object empty
+  void commit();
+
+private:
+  BipBufferWriterReservation reservation_;
+};
+
+} // namespace mvi
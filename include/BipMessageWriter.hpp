@@ -0,0 +1,44 @@
+#pragma once
+
+#include "BipBufferWriter.hpp"
+#include "BipMessageReservation.hpp"
+
+#include <cstddef>
+
+namespace mvi {
+
+/**
+ * A BipMessageWriter writes length-prefixed messages into a bip buffer through
+ * a BipBufferWriter. Each message occupies a single contiguous reservation
+ * holding a frame header followed by the payload, so a BipMessageReader can
+ * iterate over whole messages without copying.
+ */
+class BipMessageWriter {
+public:
+  /// Construct a BipMessageWriter on top of the exclusive writer for a bip buffer
+  explicit BipMessageWriter(BipBufferWriter& writer) : writer_(writer) {}
+
+  /**
+   * Tries to reserve space for a message with a payload of up to `maxLength`
+   * bytes. The reservation can be truncated to the final payload length before
+   * it is committed. If not enough space is available, an empty reservation is
+   * returned.
+   *
+   * Only one reservation can be active at a time, the same as for
+   * BipBufferWriter::reserve().
+   */
+  [[nodiscard]] BipMessageReservation reserve(size_t maxLength);
+
+  /**
+   * Writes a complete message by copying `length` bytes from `data`.
+   *
+   * @return True if the message was written, false if there was not enough
+   *   contiguous space available.
+   */
+  [[nodiscard]] bool write(const void* data, size_t length);
+
+private:
+  BipBufferWriter& writer_;
+};
+
+} // namespace mvi
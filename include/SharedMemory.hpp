@@ -11,21 +11,81 @@ namespace mvi {
  * A cross-platform abstraction for shared memory. This class provides a simple interface for
  * creating, opening, and destroying shared memory areas. The shared memory area is backed by a
  * file descriptor on Unix-like systems and a named memory-mapped file on Windows.
+ *
+ * On Unix-like systems an area can also be anonymous, see Anonymous(). It has no name that peers
+ * could look up, instead its file descriptor is passed to them over a Unix domain socket, and it
+ * is freed when the last process closes it, so it never needs to be destroyed.
  */
 class SharedMemory {
 public:
   enum class Access { ReadOnly, ReadWrite };
 
+  /// Options controlling how the shared memory area is mapped by open()
+  struct Options {
+    /**
+     * Map the part of the area starting at `mirrorOffset` a second time, directly after the end of
+     * the area. A ring buffer occupying that part can then be accessed past its end as if it
+     * continued at its start, so no access ever has to be split at the wraparound point. Both the
+     * size of the area and `mirrorOffset` must be multiples of PageSize(). Not supported on
+     * Windows.
+     */
+    bool mirror = false;
+    size_t mirrorOffset = 0; // Start of the mirrored part, the part before it is mapped once
+
+    /// Fault in every page during open(), so that the first pass over the area does not take a
+    /// page fault per page
+    bool prefault = false;
+
+    /// Lock the mapped pages in RAM so they are never swapped out. open() fails if the process
+    /// is not permitted to lock that much memory, see RLIMIT_MEMLOCK
+    bool lock = false;
+
+    /**
+     * Ask for transparent huge pages to reduce TLB pressure on large areas. A newly created area
+     * is rounded up to a multiple of HugePageSize(), unless it is mirrored. Falls back to regular
+     * pages when huge pages are unavailable or disabled, and is ignored on Windows.
+     */
+    bool hugePages = false;
+
+    /// Reserve address space for growing the area up to this many bytes with resize(). The area
+    /// then never moves, so pointers into it stay valid while it grows. Ignored on Windows
+    size_t reserve = 0;
+  };
+
   /**
    * Construct a SharedMemory object with the given name and size. The name must be unique, contain
    * only alpha-numeric characters, and be fewer than 256 characters. The size is the number of
    * bytes to allocate for the shared memory area.
    *
    * @param name the name of the shared memory area
-   * @param size the size of the shared memory area in bytes
+   * @param size the size of the shared memory area in bytes. May be zero to open an existing area
+   *   without knowing its size, which is then taken from the area itself. open() never creates an
+   *   area without a size, and fails with EAGAIN while its creator has not set the size yet
    */
   SharedMemory(const std::string& name, size_t size);
 
+  /**
+   * Construct an anonymous shared memory area of the given size, backed by memfd_create() on Linux.
+   * open() with ReadWrite access creates it, and its size is sealed against shrinking so that
+   * peers can rely on the mapped range. Peers attach by receiving the file descriptor, see send()
+   * and receive(). Not supported on Windows.
+   *
+   * @param size the size of the shared memory area in bytes. May be zero for an area that is only
+   *   going to be attached to with adopt() or receive(), which then take the size of the object
+   */
+  static SharedMemory Anonymous(size_t size);
+
+  /**
+   * Construct a shared memory area backed by a regular file, for example on a DAX file system. The
+   * contents outlive the processes using it and can be flushed to the file with sync() or with
+   * BipBufferWriter::setDurability(). open() with ReadWrite access creates the file if it does not
+   * exist. The path is returned by name(), and Destroy() does not apply. Not supported on Windows.
+   *
+   * @param path the path of the file
+   * @param size the size of the shared memory area in bytes
+   */
+  static SharedMemory File(const std::string& path, size_t size);
+
   /// Close the shared memory area if it is still open on destruction
   ~SharedMemory();
 
@@ -46,14 +106,63 @@ public:
    */
   std::optional<std::system_error> open(Access access);
 
+  /**
+   * Open the shared memory area for reading or writing, mapping it as described by `options`.
+   *
+   * @param access the access mode, ReadOnly or ReadWrite
+   * @param options how to map the shared memory area
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> open(Access access, const Options& options);
+
+  /**
+   * Take ownership of a file descriptor referring to a shared memory object, such as the memfd of
+   * an anonymous area received from another process, and map it. Any previously open area is
+   * closed. If the size of this object is zero it is set to the size of the shared memory object.
+   *
+   * @param fd the file descriptor, which is closed on failure
+   * @param access the access mode, ReadOnly or ReadWrite
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> adopt(int fd, Access access);
+
+  /// Take ownership of a file descriptor and map it as described by `options`, see adopt()
+  std::optional<std::system_error> adopt(int fd, Access access, const Options& options);
+
+  /**
+   * Send the file descriptor of the open shared memory area to the peer of a connected Unix domain
+   * socket, which attaches to it with receive().
+   *
+   * @param socket a connected AF_UNIX socket
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> send(int socket) const;
+
+  /**
+   * Receive a file descriptor sent with send() and adopt it.
+   *
+   * @param socket a connected AF_UNIX socket
+   * @param access the access mode, ReadOnly or ReadWrite
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> receive(int socket, Access access);
+
+  /// Receive a file descriptor sent with send() and adopt it, mapping it as described by `options`
+  std::optional<std::system_error> receive(int socket, Access access, const Options& options);
+
+  /// Returns the file descriptor backing the open shared memory area, or -1 if there is none
+  int fd() const;
+
   /// Returns the name of the shared memory area, set during construction
   const std::string& name() const;
 
-  /// Returns the size of the shared memory area, set during construction
+  /// Returns the size of the shared memory area, set during construction, by open() for an area
+  /// constructed without a size, or by resize()
   size_t size() const;
 
-  /// Returns the total capacity in bytes of the shared memory area. This will be greater than or
-  /// equal to the size of the shared memory area
+  /// Returns the total capacity in bytes of the shared memory area, which is the size rounded up to
+  /// the page size, or to the huge page size with Options::hugePages. All of it is mapped and
+  /// shared, and it may be larger still if the area was created with a larger size
   size_t capacity() const;
 
   /// Returns a pointer to the start of the shared memory area
@@ -65,21 +174,53 @@ public:
   /// Closes the shared memory area
   std::optional<std::system_error> close();
 
+  /**
+   * Grow the open shared memory area to at least `size` bytes without moving it, within the
+   * address space reserved with Options::reserve. With ReadWrite access the shared memory object
+   * is enlarged if needed, while with ReadOnly access another process must have enlarged it
+   * already. Other processes see the new part once they resize() their own mapping. Shrinking is
+   * not supported and mirrored areas can not be resized. Not supported on Windows.
+   *
+   * @param size the new size of the shared memory area in bytes
+   * @return std::nullopt if the operation was successful, otherwise a std::system_error
+   */
+  std::optional<std::system_error> resize(size_t size);
+
+  /// Flushes the whole shared memory area to its backing file and waits for the write-back. Mostly
+  /// useful for areas created with File()
+  std::optional<std::system_error> sync() const;
+
   /// Static method to destroy a shared memory area by name. Succeeds if the shared memory area is
   /// successfully destroyed or does not exist
   static std::optional<std::system_error> Destroy(const std::string& name);
 
+  /// Returns the granularity of mapping sizes and offsets, which Options::mirror requires the size
+  /// and the mirror offset to be a multiple of
+  static size_t PageSize();
+
+  /// Returns the size of a transparent huge page, or PageSize() if huge pages are not supported
+  static size_t HugePageSize();
+
 private:
   std::string name_;
   std::string normalizedName_;
   void* data_ = nullptr;
   size_t size_ = 0;
   size_t capacity_ = 0;
+  size_t mappedSize_ = 0; // Length of the mapping, including the mirror
+  enum class Backing { Named, Anonymous, File };
+  Backing backing_ = Backing::Named; // What `name_` refers to, if anything
 #ifdef _WIN32
   using HANDLE = void*;
   HANDLE handle_;
 #else
   int fd_ = -1;
+  size_t reservedSize_ = 0; // Address space reserved for the mapping and its growth
+  Access access_ = Access::ReadOnly; // Access of the open mapping
+  Options options_; // Options of the open mapping
+
+  // Maps `fd_` once its size is known, applying `options`
+  std::optional<std::system_error> map(Access access, const Options& options);
 #endif // _WIN32
 
   std::optional<std::system_error> createOrOpen(bool create);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <optional>
+#include <system_error>
+
+namespace mvi {
+
+/**
+ * Send a file descriptor, such as a BipBufferNotifier's eventfd or a memfd
+ * backing a SharedMemory area, to the peer of a connected Unix domain socket.
+ * The descriptor stays open in the sending process.
+ *
+ * @param socket a connected AF_UNIX socket, for example from socketpair()
+ * @param fd the file descriptor to send
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> SendFileDescriptor(int socket, int fd);
+
+/**
+ * Receive a file descriptor sent with SendFileDescriptor(). The caller owns
+ * the received descriptor, which refers to the same open file as the one sent.
+ *
+ * @param socket a connected AF_UNIX socket
+ * @param fd set to the received file descriptor on success
+ * @return std::nullopt if the operation was successful, otherwise a std::system_error
+ */
+std::optional<std::system_error> ReceiveFileDescriptor(int socket, int& fd);
+
+} // namespace mvi
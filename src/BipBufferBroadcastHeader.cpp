@@ -0,0 +1,71 @@
+#include "BipBufferBroadcastHeader.hpp"
+
+#include <new> // IWYU pragma: keep (placement new)
+
+namespace mvi {
+
+const uint8_t* BipBufferBroadcastHeader::buffer() const {
+  return reinterpret_cast<const uint8_t*>(this) + sizeof(BipBufferBroadcastHeader);
+}
+
+uint8_t* BipBufferBroadcastHeader::buffer() {
+  return reinterpret_cast<uint8_t*>(this) + sizeof(BipBufferBroadcastHeader);
+}
+
+std::optional<size_t> BipBufferBroadcastHeader::registerReader() {
+  for (size_t slot = 0; slot < MAX_READERS; ++slot) {
+    uint64_t expected = FREE;
+    if (readers[slot].read.compare_exchange_strong(
+          expected, JOINING, std::memory_order_relaxed, std::memory_order_relaxed)) {
+      joinRequests.fetch_add(1, std::memory_order_release);
+      return slot;
+    }
+  }
+  return std::nullopt;
+}
+
+void BipBufferBroadcastHeader::unregisterReader(size_t slot) {
+  if (slot >= MAX_READERS) { return; }
+  // A reader that is still joining also withdraws its join request
+  uint64_t expected = JOINING;
+  if (readers[slot].read.compare_exchange_strong(
+        expected, FREE, std::memory_order_relaxed, std::memory_order_relaxed)) {
+    joinRequests.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+  // Release ordering so the reader's accesses to the buffer happen-before the
+  // writer reuses the space it was holding
+  readers[slot].read.store(FREE, std::memory_order_release);
+}
+
+BipBufferBroadcastHeader* BipBufferBroadcastHeader::Create(uint8_t* data, size_t size) {
+  if (!data || size <= sizeof(BipBufferBroadcastHeader)) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferBroadcastHeader) != 0) {
+    return nullptr;
+  }
+  // Explicitly using a raw pointer to indicate non-ownership
+  auto layout = new (data) BipBufferBroadcastHeader(); // NOLINT(cppcoreguidelines-owning-memory)
+  layout->magic = MAGIC;
+  layout->version = VERSION;
+  layout->bufferSize = uint64_t(size - sizeof(BipBufferBroadcastHeader));
+  layout->joinRequests = 0;
+  layout->last = 0;
+  layout->write = 0;
+  for (Cursor& cursor : layout->readers) {
+    cursor.read = FREE;
+  }
+  return layout;
+}
+
+BipBufferBroadcastHeader* BipBufferBroadcastHeader::Attach(uint8_t* data, size_t size) {
+  if (!data || size <= sizeof(BipBufferBroadcastHeader)) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferBroadcastHeader) != 0) {
+    return nullptr;
+  }
+  auto layout = reinterpret_cast<BipBufferBroadcastHeader*>(data);
+  if (layout->magic != MAGIC || layout->version != VERSION) { return nullptr; }
+  if (layout->bufferSize > size - sizeof(BipBufferBroadcastHeader)) { return nullptr; }
+  return layout;
+}
+
+} // namespace mvi
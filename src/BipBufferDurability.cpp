@@ -0,0 +1,48 @@
+#include "BipBufferDurability.hpp"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <errno.h> // errno
+#include <sys/mman.h> // ::msync()
+#include <unistd.h> // ::sysconf()
+#endif // _WIN32
+
+namespace mvi {
+
+#ifdef _WIN32
+
+// FlushViewOfFile() writes the pages but does not wait for the disk cache,
+// which would need the file handle, so Sync is as durable as Async here
+std::optional<std::system_error> SyncMemory(
+  const void* data, size_t length, Durability durability) {
+  if (durability == Durability::None || length == 0) { return {}; }
+  if (!FlushViewOfFile(data, length)) {
+    return std::system_error(int(GetLastError()), std::system_category(), "FlushViewOfFile");
+  }
+  return {};
+}
+
+#else
+
+std::optional<std::system_error> SyncMemory(
+  const void* data, size_t length, Durability durability) {
+  if (durability == Durability::None || length == 0) { return {}; }
+  static const auto pageSize = uintptr_t(::sysconf(_SC_PAGESIZE));
+  const auto begin = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+  const auto end = reinterpret_cast<uintptr_t>(data) + length;
+  const int flags = durability == Durability::Sync ? MS_SYNC : MS_ASYNC;
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  if (::msync(reinterpret_cast<void*>(begin), size_t(end - begin), flags) != 0) {
+    return std::system_error(errno, std::system_category(), "msync");
+  }
+  return {};
+}
+
+#endif // _WIN32
+
+} // namespace mvi
@@ -0,0 +1,506 @@
+#include "BipBufferFileSink.hpp"
+
+#include <algorithm> // for min
+#include <condition_variable>
+#include <cstring> // for memset
+#include <mutex>
+#include <thread>
+#include <utility> // for swap
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <errno.h> // errno
+#include <limits.h> // IOV_MAX
+#include <sys/uio.h> // ::pwritev()
+#endif // _WIN32
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h> // ::mmap(), ::munmap()
+#include <sys/syscall.h>
+#include <unistd.h> // ::syscall(), ::close()
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// Memory ordering: the bytes submitted are only ever read by the kernel or the
+// worker thread, and the reader is advanced past them only after their
+// completion has been observed, so the writer can not reuse space that is
+// still being written out. The worker thread hands requests and completions
+// over under a mutex. The io_uring submission tail is stored with release
+// ordering after the submission entry has been filled in, and the completion
+// tail is loaded with acquire ordering before the entries are read, as the
+// io_uring ABI requires; the completion head is released once they have been
+// consumed.
+
+namespace mvi {
+
+#ifdef __linux__
+
+struct BipBufferFileSink::Ring {
+  int fd = -1;
+  void* sqRing = MAP_FAILED;
+  size_t sqRingSize = 0;
+  void* cqRing = MAP_FAILED; // Same as `sqRing` with IORING_FEAT_SINGLE_MMAP
+  size_t cqRingSize = 0;
+  io_uring_sqe* sqes = nullptr;
+  size_t sqesSize = 0;
+  uint32_t* sqTail = nullptr;
+  uint32_t* sqMask = nullptr;
+  uint32_t* sqArray = nullptr;
+  uint32_t* cqHead = nullptr;
+  uint32_t* cqTail = nullptr;
+  uint32_t* cqMask = nullptr;
+  io_uring_cqe* cqes = nullptr;
+  unsigned queued = 0; // Submission entries not yet passed to io_uring_enter()
+  const uint8_t* registered = nullptr; // Memory registered with registerBuffer()
+  size_t registeredSize = 0;
+
+  ~Ring() {
+    if (sqes) { ::munmap(sqes, sqesSize); }
+    if (cqRing != MAP_FAILED && cqRing != sqRing) { ::munmap(cqRing, cqRingSize); }
+    if (sqRing != MAP_FAILED) { ::munmap(sqRing, sqRingSize); }
+    if (fd >= 0) { ::close(fd); }
+  }
+
+  std::optional<std::system_error> setup(unsigned entries) {
+    io_uring_params params{};
+    fd = int(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) { return std::system_error(errno, std::system_category(), "io_uring_setup"); }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) { sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize); }
+    sqRing = ::mmap(nullptr,
+      sqRingSize,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) { return std::system_error(errno, std::system_category(), "mmap"); }
+    cqRing = singleMap ? sqRing
+                       : ::mmap(nullptr,
+                           cqRingSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE,
+                           fd,
+                           IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED) { return std::system_error(errno, std::system_category(), "mmap"); }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqesMap = ::mmap(nullptr,
+      sqesSize,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      IORING_OFF_SQES);
+    if (sqesMap == MAP_FAILED) { return std::system_error(errno, std::system_category(), "mmap"); }
+    sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+    auto* sq = static_cast<uint8_t*>(sqRing);
+    auto* cq = static_cast<uint8_t*>(cqRing);
+    sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return probe();
+  }
+
+  // Checks that the kernel supports IORING_OP_WRITE. It was added in Linux
+  // 5.6, while io_uring itself exists since 5.1, and every write would fail
+  // with EINVAL on kernels in between. Probing was added in 5.6 as well, so a
+  // failed probe also means the opcode is missing
+  std::optional<std::system_error> probe() {
+    constexpr unsigned OPS = 256;
+    alignas(io_uring_probe) uint8_t storage[sizeof(io_uring_probe) +
+                                            OPS * sizeof(io_uring_probe_op)] = {};
+    auto* ops = reinterpret_cast<io_uring_probe*>(storage);
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, ops, OPS) != 0) {
+      return std::system_error(errno, std::system_category(), "io_uring_register");
+    }
+    if (ops->ops_len <= IORING_OP_WRITE ||
+        (ops->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) == 0) {
+      return std::system_error(
+        std::make_error_code(std::errc::function_not_supported), "io_uring write");
+    }
+    return {};
+  }
+
+  // Queues a write, which is passed to the kernel by the next enter(). There
+  // is always a free entry, since there are at least as many entries as slots
+  void queue(int target, const uint8_t* data, size_t length, uint64_t offset, uint64_t tag) {
+    const uint32_t tail = *sqTail; // Only stored by this thread
+    const uint32_t index = tail & *sqMask;
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    const bool fixed =
+      registered && data >= registered && data + length <= registered + registeredSize;
+    sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd = target;
+    sqe.addr = uint64_t(reinterpret_cast<uintptr_t>(data));
+    sqe.len = uint32_t(length);
+    sqe.off = offset;
+    sqe.buf_index = 0;
+    sqe.user_data = tag;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++queued;
+  }
+
+  // Submits the queued entries, waiting for `minComplete` completions
+  std::optional<std::system_error> enter(unsigned minComplete) {
+    const unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (queued == 0 && minComplete == 0) { return {}; }
+    long submitted;
+    do {
+      submitted = ::syscall(__NR_io_uring_enter, fd, queued, minComplete, flags, nullptr, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted < 0) {
+      // Out of resources for now, the entries stay queued for the next call
+      if (errno == EAGAIN || errno == EBUSY) { return {}; }
+      return std::system_error(errno, std::system_category(), "io_uring_enter");
+    }
+    queued -= std::min(queued, unsigned(submitted));
+    return {};
+  }
+
+  // Passes every available completion to `consume(tag, result)`
+  template<typename Consume> void reap(Consume consume) {
+    uint32_t head = *cqHead; // Only stored by this thread
+    const uint32_t tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & *cqMask];
+      consume(size_t(cqe.user_data), int64_t(cqe.res));
+    }
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+  }
+
+  std::optional<std::system_error> registerMemory(const void* data, size_t size) {
+    if (registered) {
+      ::syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+      registered = nullptr;
+    }
+    iovec iov{const_cast<void*>(data), size};
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &iov, 1) != 0) {
+      return std::system_error(errno, std::system_category(), "io_uring_register");
+    }
+    registered = static_cast<const uint8_t*>(data);
+    registeredSize = size;
+    return {};
+  }
+};
+
+#else
+
+// io_uring is Linux only, the worker thread is used everywhere else
+struct BipBufferFileSink::Ring {
+  unsigned queued = 0;
+
+  std::optional<std::system_error> setup(unsigned) {
+    return std::system_error(std::make_error_code(std::errc::function_not_supported), "io_uring");
+  }
+  void queue(int, const uint8_t*, size_t, uint64_t, uint64_t) {}
+  std::optional<std::system_error> enter(unsigned) { return {}; }
+  template<typename Consume> void reap(Consume) {}
+  std::optional<std::system_error> registerMemory(const void*, size_t) { return {}; }
+};
+
+#endif // __linux__
+
+struct BipBufferFileSink::Worker {
+  struct Request {
+    size_t slot;
+    const uint8_t* data;
+    size_t length;
+    uint64_t offset;
+  };
+
+  int fd;
+  std::mutex mutex;
+  std::condition_variable requested; // Signaled when `requests` or `stop` change
+  std::condition_variable completed; // Signaled when `completions` change
+  std::vector<Request> requests;
+  std::vector<std::pair<size_t, int64_t>> completions; // Slot and result of finished writes
+  bool stop = false;
+  std::thread thread;
+
+  explicit Worker(int target)
+    : fd(target),
+      thread([this] { run(); }) {}
+
+  ~Worker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    requested.notify_one();
+    thread.join();
+  }
+
+  void run() {
+    std::vector<Request> batch;
+    std::vector<std::pair<size_t, int64_t>> results;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        requested.wait(lock, [this] { return stop || !requests.empty(); });
+        if (requests.empty()) { return; }
+        std::swap(batch, requests);
+      }
+
+      // Requests are queued in file order, so runs of adjacent writes are
+      // written with a single pwritev() each
+      results.clear();
+      for (size_t first = 0; first < batch.size();) {
+        size_t last = first + 1;
+        while (last < batch.size() && last - first < size_t(IOV_MAX) &&
+               batch[last].offset == batch[last - 1].offset + batch[last - 1].length) {
+          ++last;
+        }
+        const int64_t error = write(batch.data() + first, last - first);
+        for (size_t i = first; i < last; ++i) {
+          results.emplace_back(batch[i].slot, error != 0 ? error : int64_t(batch[i].length));
+        }
+        first = last;
+      }
+      batch.clear();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        completions.insert(completions.end(), results.begin(), results.end());
+      }
+      completed.notify_one();
+    }
+  }
+
+  // Writes a run of adjacent requests completely. Returns zero or a negative errno
+  int64_t write(const Request* run, size_t count) {
+#ifdef _WIN32
+    (void)run;
+    (void)count;
+    return -1; // Unreachable, open() fails on Windows
+#else
+    std::vector<iovec> iov(count);
+    for (size_t i = 0; i < count; ++i) {
+      iov[i] = {const_cast<uint8_t*>(run[i].data), run[i].length};
+    }
+    uint64_t offset = run[0].offset;
+    size_t index = 0;
+    while (index < count) {
+      const ssize_t written =
+        ::pwritev(fd, iov.data() + index, int(count - index), off_t(offset));
+      if (written < 0 && errno == EINTR) { continue; }
+      if (written < 0) { return -int64_t(errno); }
+      if (written == 0) { return -int64_t(EIO); }
+      // Skip what was written and retry the rest
+      offset += uint64_t(written);
+      size_t remaining = size_t(written);
+      while (index < count && remaining >= iov[index].iov_len) {
+        remaining -= iov[index].iov_len;
+        ++index;
+      }
+      if (index < count) {
+        iov[index].iov_base = static_cast<uint8_t*>(iov[index].iov_base) + remaining;
+        iov[index].iov_len -= remaining;
+      }
+    }
+    return 0;
+#endif
+  }
+};
+
+BipBufferFileSink::BipBufferFileSink(BipBufferReader& reader)
+  : reader_(reader) {}
+
+BipBufferFileSink::~BipBufferFileSink() {
+  close();
+}
+
+std::optional<std::system_error> BipBufferFileSink::open(
+  int fd, uint64_t offset, size_t queueDepth, Mode mode) {
+  close();
+  if (fd < 0 || queueDepth == 0) {
+    return std::system_error(
+      std::make_error_code(std::errc::invalid_argument), "invalid descriptor or queue depth");
+  }
+#ifdef _WIN32
+  (void)offset;
+  (void)mode;
+  return std::system_error(
+    ERROR_NOT_SUPPORTED, std::system_category(), "file sinks are not supported");
+#else
+  if (mode != Mode::Thread) {
+    ring_ = std::make_unique<Ring>();
+    if (auto err = ring_->setup(unsigned(queueDepth))) {
+      ring_.reset();
+      if (mode == Mode::IoUring) { return err; }
+    }
+  }
+  if (!ring_) { worker_ = std::make_unique<Worker>(fd); }
+
+  fd_ = fd;
+  writes_.assign(queueDepth, Write{});
+  submittedOffset_ = offset;
+  completedOffset_ = offset;
+  return {};
+#endif
+}
+
+std::optional<std::system_error> BipBufferFileSink::registerBuffer(const void* data, size_t size) {
+  if (!ring_) { return {}; }
+  if (outstanding_ > 0) {
+    return std::system_error(
+      std::make_error_code(std::errc::device_or_resource_busy), "writes in flight");
+  }
+  return ring_->registerMemory(data, size);
+}
+
+void BipBufferFileSink::submit(size_t slot) {
+  const Write& write = writes_[slot];
+  const uint8_t* data = write.data + write.written;
+  const size_t length = write.length - write.written;
+  const uint64_t offset = write.offset + write.written;
+  ++outstanding_;
+  if (ring_) {
+    ring_->queue(fd_, data, length, offset, slot);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(worker_->mutex);
+    worker_->requests.push_back({slot, data, length, offset});
+  }
+  worker_->requested.notify_one();
+}
+
+void BipBufferFileSink::complete(size_t slot, int64_t result) {
+  --outstanding_;
+  if (error_) { return; }
+  if (result < 0) {
+    error_ = std::system_error(int(-result), std::system_category(), "write");
+    return;
+  }
+  if (result == 0) {
+    error_ = std::system_error(EIO, std::system_category(), "write made no progress");
+    return;
+  }
+  Write& write = writes_[slot];
+  write.written += size_t(result);
+  if (write.written < write.length) { submit(slot); } // Short write, resubmit the rest
+}
+
+std::optional<std::system_error> BipBufferFileSink::reap(bool block) {
+  if (ring_) {
+    if (auto err = ring_->enter(block && outstanding_ > 0 ? 1 : 0)) {
+      if (!error_) { error_ = err; }
+    }
+    ring_->reap([this](size_t slot, int64_t result) { complete(slot, result); });
+  } else if (worker_) {
+    std::vector<std::pair<size_t, int64_t>> completions;
+    {
+      std::unique_lock<std::mutex> lock(worker_->mutex);
+      if (block && outstanding_ > 0) {
+        worker_->completed.wait(lock, [this] { return !worker_->completions.empty(); });
+      }
+      std::swap(completions, worker_->completions);
+    }
+    for (const auto& [slot, result] : completions) {
+      complete(slot, result);
+    }
+  }
+  if (error_) { return error_; }
+
+  // Consume the completed writes in order
+  while (count_ > 0 && writes_[head_].written == writes_[head_].length) {
+    const size_t length = writes_[head_].length;
+    (void)reader_.advance(length); // Never more than readAll() returned
+    submittedBytes_ -= length;
+    completedOffset_ += length;
+    head_ = (head_ + 1) % writes_.size();
+    --count_;
+  }
+  return {};
+}
+
+std::optional<std::system_error> BipBufferFileSink::poll() {
+  if (fd_ < 0) { return std::system_error(std::make_error_code(std::errc::bad_file_descriptor)); }
+  if (auto err = reap(false)) { return err; }
+
+  // Submit the readable bytes that are not in flight yet, skipping those that are
+  size_t skip = submittedBytes_;
+  for (const std::string_view segment : reader_.readAll()) {
+    if (skip >= segment.size()) {
+      skip -= segment.size();
+      continue;
+    }
+    const auto* data = reinterpret_cast<const uint8_t*>(segment.data()) + skip;
+    size_t remaining = segment.size() - skip;
+    skip = 0;
+    while (remaining > 0 && count_ < writes_.size()) {
+      const size_t length = std::min(remaining, MAX_WRITE_SIZE);
+      const size_t slot = (head_ + count_) % writes_.size();
+      writes_[slot] = Write{data, length, submittedOffset_, 0};
+      submit(slot);
+      ++count_;
+      submittedBytes_ += length;
+      submittedOffset_ += length;
+      data += length;
+      remaining -= length;
+    }
+  }
+
+  if (ring_) {
+    if (auto err = ring_->enter(0)) {
+      if (!error_) { error_ = err; }
+    }
+  }
+  return error_;
+}
+
+std::optional<std::system_error> BipBufferFileSink::wait() {
+  if (fd_ < 0) { return std::system_error(std::make_error_code(std::errc::bad_file_descriptor)); }
+  if (auto err = reap(true)) { return err; }
+  return poll();
+}
+
+std::optional<std::system_error> BipBufferFileSink::drain() {
+  if (auto err = poll()) { return err; }
+  const auto segments = reader_.readAll();
+  const uint64_t target = completedOffset_ + segments[0].size() + segments[1].size();
+  while (completedOffset_ < target) {
+    if (auto err = wait()) { return err; }
+  }
+  return {};
+}
+
+std::optional<std::system_error> BipBufferFileSink::close() {
+  // The kernel or the worker may still be reading from the buffer
+  while (outstanding_ > 0) {
+    const size_t before = outstanding_;
+    reap(true);
+    if (ring_ && outstanding_ == before && ring_->queued > 0) {
+      // Entries that were never submitted will not complete
+      outstanding_ -= ring_->queued;
+      ring_->queued = 0;
+    }
+  }
+  ring_.reset();
+  worker_.reset();
+  fd_ = -1;
+  writes_.clear();
+  head_ = 0;
+  count_ = 0;
+  submittedBytes_ = 0;
+  std::optional<std::system_error> err;
+  std::swap(err, error_);
+  return err;
+}
+
+} // namespace mvi
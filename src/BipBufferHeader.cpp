@@ -23,4 +23,18 @@ BipBufferHeader* BipBufferHeader::Create(uint8_t* data, size_t size) {
   return layout;
 }
 
+BipBufferHeader* BipBufferHeader::Attach(uint8_t* data, size_t size) {
+  if (!data || size <= sizeof(BipBufferHeader)) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferHeader) != 0) { return nullptr; }
+  auto layout = reinterpret_cast<BipBufferHeader*>(data);
+  const uint64_t bufferSize = layout->bufferSize;
+  if (bufferSize == 0 || bufferSize > size - sizeof(BipBufferHeader)) { return nullptr; }
+  if (layout->read.load(std::memory_order_relaxed) > bufferSize ||
+      layout->write.load(std::memory_order_relaxed) > bufferSize ||
+      layout->last.load(std::memory_order_relaxed) > bufferSize) {
+    return nullptr;
+  }
+  return layout;
+}
+
 } // namespace mvi
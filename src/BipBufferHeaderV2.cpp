@@ -0,0 +1,86 @@
+#include "BipBufferHeaderV2.hpp"
+#include "BipBufferStatistics.hpp"
+
+#include <new> // IWYU pragma: keep (placement new)
+
+namespace mvi {
+
+const uint8_t* BipBufferHeaderV2::buffer() const {
+  return reinterpret_cast<const uint8_t*>(this) + bufferOffset;
+}
+
+uint8_t* BipBufferHeaderV2::buffer() {
+  return reinterpret_cast<uint8_t*>(this) + bufferOffset;
+}
+
+const BipBufferStatistics* BipBufferHeaderV2::statistics() const {
+  if ((flags & FLAG_STATISTICS) == 0) { return nullptr; }
+  return reinterpret_cast<const BipBufferStatistics*>(this + 1);
+}
+
+BipBufferStatistics* BipBufferHeaderV2::statistics() {
+  if ((flags & FLAG_STATISTICS) == 0) { return nullptr; }
+  return reinterpret_cast<BipBufferStatistics*>(this + 1);
+}
+
+size_t BipBufferHeaderV2::HeaderSize(uint32_t flags) {
+  const bool statistics = (flags & FLAG_STATISTICS) != 0;
+  return sizeof(BipBufferHeaderV2) + (statistics ? sizeof(BipBufferStatistics) : 0);
+}
+
+BipBufferHeaderV2* BipBufferHeaderV2::Create(uint8_t* data, size_t size, uint32_t flags) {
+  if ((flags & FLAG_MIRRORED) != 0) { return nullptr; }
+  return Construct(data, size, HeaderSize(flags), flags);
+}
+
+BipBufferHeaderV2* BipBufferHeaderV2::CreateMirrored(
+  uint8_t* data, size_t size, size_t bufferOffset, uint32_t flags) {
+  if (bufferOffset < HeaderSize(flags) || bufferOffset % CACHE_LINE_SIZE != 0) {
+    return nullptr;
+  }
+  return Construct(data, size, bufferOffset, flags | FLAG_MIRRORED);
+}
+
+BipBufferHeaderV2* BipBufferHeaderV2::Construct(
+  uint8_t* data, size_t size, size_t bufferOffset, uint32_t flags) {
+  if (!data || size <= bufferOffset || bufferOffset > UINT32_MAX) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferHeaderV2) != 0) { return nullptr; }
+  // Explicitly using a raw pointer to indicate non-ownership
+  auto layout = new (data) BipBufferHeaderV2(); // NOLINT(cppcoreguidelines-owning-memory)
+  layout->magic = MAGIC;
+  layout->version = VERSION;
+  layout->bufferSize = uint64_t(size - bufferOffset);
+  layout->flags = flags;
+  layout->bufferOffset = uint32_t(bufferOffset);
+  layout->writerWaiting = 0;
+  layout->read = 0;
+  layout->readerWaiting = 0;
+  layout->generation = 0;
+  layout->requestedSize = layout->bufferSize;
+  layout->acknowledgedGeneration = 0;
+  layout->acknowledgedSize = layout->bufferSize;
+  layout->last = 0;
+  layout->write = 0;
+  if ((flags & FLAG_STATISTICS) != 0) {
+    // Zero-initialized, so counting starts afresh when a buffer is recreated
+    new (layout + 1) BipBufferStatistics(); // NOLINT(cppcoreguidelines-owning-memory)
+  }
+  return layout;
+}
+
+BipBufferHeaderV2* BipBufferHeaderV2::Attach(uint8_t* data, size_t size) {
+  if (!data || size <= sizeof(BipBufferHeaderV2)) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferHeaderV2) != 0) { return nullptr; }
+  auto layout = reinterpret_cast<BipBufferHeaderV2*>(data);
+  if (layout->magic != MAGIC || layout->version != VERSION) { return nullptr; }
+  if (layout->bufferOffset < HeaderSize(layout->flags) || layout->bufferOffset >= size) {
+    return nullptr;
+  }
+  if (layout->bufferSize > size - layout->bufferOffset) { return nullptr; }
+  if (layout->acknowledgedSize.load(std::memory_order_relaxed) > size - layout->bufferOffset) {
+    return nullptr;
+  }
+  return layout;
+}
+
+} // namespace mvi
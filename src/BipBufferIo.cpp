@@ -0,0 +1,141 @@
+#include "BipBufferIo.hpp"
+
+#include <array>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <errno.h> // errno
+#include <sys/socket.h> // ::sendmsg(), ::recv()
+#include <sys/uio.h> // ::writev(), struct iovec
+#include <unistd.h> // ::read()
+#endif // _WIN32
+
+// Memory ordering: the adapters only use the public reader and writer API.
+// The kernel copies the readable bytes out of the buffer before advance()
+// releases them to the writer, and copies received bytes into the reservation
+// before its commit publishes them to the reader.
+
+namespace mvi {
+
+#ifdef _WIN32
+
+static std::optional<std::system_error> NotSupported(size_t& bytes) {
+  bytes = 0;
+  return std::system_error(
+    ERROR_NOT_SUPPORTED, std::system_category(), "file descriptor I/O is not supported");
+}
+
+std::optional<std::system_error> DrainToFd(int, BipBufferReader&, size_t& bytes) {
+  return NotSupported(bytes);
+}
+
+std::optional<std::system_error> DrainToSocket(int, BipBufferReader&, size_t& bytes) {
+  return NotSupported(bytes);
+}
+
+std::optional<std::system_error> FillFromFd(int, BipBufferWriter&, size_t, size_t& bytes) {
+  return NotSupported(bytes);
+}
+
+std::optional<std::system_error> FillFromSocket(int, BipBufferWriter&, size_t, size_t& bytes) {
+  return NotSupported(bytes);
+}
+
+#else
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SO_NOSIGPIPE has to be set on the socket instead
+#endif
+
+// Drains the readable bytes with `transfer`, which moves the given segments
+// and returns the number of bytes moved or -1 with errno set
+template<typename Transfer>
+static std::optional<std::system_error> Drain(
+  BipBufferReader& reader, size_t& bytes, const char* operation, Transfer transfer) {
+  bytes = 0;
+  const auto segments = reader.readAll();
+  if (segments[0].empty()) { return {}; }
+
+  // The kernel only reads from the segments
+  std::array<iovec, 2> iov{};
+  iov[0] = {const_cast<char*>(segments[0].data()), segments[0].size()};
+  iov[1] = {const_cast<char*>(segments[1].data()), segments[1].size()};
+  const int count = segments[1].empty() ? 1 : 2;
+
+  ssize_t result;
+  do {
+    result = transfer(iov.data(), count);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) { return std::system_error(errno, std::system_category(), operation); }
+
+  bytes = size_t(result);
+  (void)reader.advance(bytes); // Never more than readAll() returned
+  return {};
+}
+
+// Fills a reservation of up to `maxLength` bytes with `transfer`, which moves
+// bytes into the given range and returns the number of bytes moved or -1 with
+// errno set
+template<typename Transfer>
+static std::optional<std::system_error> Fill(BipBufferWriter& writer,
+  size_t maxLength,
+  size_t& bytes,
+  const char* operation,
+  Transfer transfer) {
+  bytes = 0;
+  auto reservation = writer.reserveAtMost(maxLength);
+  if (!reservation) {
+    return std::system_error(ENOBUFS, std::system_category(), "buffer is full");
+  }
+
+  ssize_t result;
+  do {
+    result = transfer(reservation.data(), reservation.size());
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    const int err = errno;
+    reservation.cancel();
+    return std::system_error(err, std::system_category(), operation);
+  }
+
+  // Commit only what was transferred, an empty reservation commits nothing
+  bytes = size_t(result);
+  (void)reservation.truncate(bytes);
+  return {};
+}
+
+std::optional<std::system_error> DrainToFd(int fd, BipBufferReader& reader, size_t& bytes) {
+  return Drain(reader, bytes, "writev", [fd](const iovec* iov, int count) {
+    return ::writev(fd, iov, count);
+  });
+}
+
+std::optional<std::system_error> DrainToSocket(int socket, BipBufferReader& reader, size_t& bytes) {
+  return Drain(reader, bytes, "sendmsg", [socket](const iovec* iov, int count) {
+    msghdr message{};
+    message.msg_iov = const_cast<iovec*>(iov);
+    message.msg_iovlen = decltype(message.msg_iovlen)(count);
+    return ::sendmsg(socket, &message, MSG_NOSIGNAL);
+  });
+}
+
+std::optional<std::system_error> FillFromFd(
+  int fd, BipBufferWriter& writer, size_t maxLength, size_t& bytes) {
+  return Fill(writer, maxLength, bytes, "read", [fd](uint8_t* data, size_t length) {
+    return ::read(fd, data, length);
+  });
+}
+
+std::optional<std::system_error> FillFromSocket(
+  int socket, BipBufferWriter& writer, size_t maxLength, size_t& bytes) {
+  return Fill(writer, maxLength, bytes, "recv", [socket](uint8_t* data, size_t length) {
+    return ::recv(socket, data, length, 0);
+  });
+}
+
+#endif // _WIN32
+
+} // namespace mvi
@@ -0,0 +1,38 @@
+#include "BipBufferLossyHeader.hpp"
+
+#include <algorithm> // for min
+#include <new> // IWYU pragma: keep (placement new)
+
+namespace mvi {
+
+std::atomic<uint64_t>* BipBufferLossyHeader::words() {
+  return reinterpret_cast<std::atomic<uint64_t>*>(
+    reinterpret_cast<uint8_t*>(this) + sizeof(BipBufferLossyHeader));
+}
+
+BipBufferLossyHeader* BipBufferLossyHeader::Create(uint8_t* data, size_t size) {
+  if (!data || size < sizeof(BipBufferLossyHeader) + 2 * RECORD_HEADER_SIZE) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferLossyHeader) != 0) { return nullptr; }
+  // Explicitly using a raw pointer to indicate non-ownership
+  auto layout = new (data) BipBufferLossyHeader(); // NOLINT(cppcoreguidelines-owning-memory)
+  layout->magic = MAGIC;
+  layout->version = VERSION;
+  const size_t bufferSize = std::min(size - sizeof(BipBufferLossyHeader), MAX_BUFFER_SIZE);
+  layout->bufferSize = uint64_t(bufferSize - bufferSize % RECORD_ALIGNMENT);
+  layout->sequence = 0;
+  layout->tail = 0;
+  layout->head = 0;
+  return layout;
+}
+
+BipBufferLossyHeader* BipBufferLossyHeader::Attach(uint8_t* data, size_t size) {
+  if (!data || size < sizeof(BipBufferLossyHeader) + 2 * RECORD_HEADER_SIZE) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferLossyHeader) != 0) { return nullptr; }
+  auto layout = reinterpret_cast<BipBufferLossyHeader*>(data);
+  if (layout->magic != MAGIC || layout->version != VERSION) { return nullptr; }
+  if (layout->bufferSize > size - sizeof(BipBufferLossyHeader)) { return nullptr; }
+  if (layout->bufferSize % RECORD_ALIGNMENT != 0) { return nullptr; }
+  return layout;
+}
+
+} // namespace mvi
@@ -0,0 +1,88 @@
+#include "BipBufferLossyReader.hpp"
+
+#include <algorithm> // for min
+#include <cstring> // for memcpy
+
+namespace mvi {
+
+// Memory ordering: `head` is loaded with acquire ordering, which pairs with
+// the writer's release store in BipBufferLossyWriter::write() and makes the
+// records before it visible. Records are copied with relaxed loads, since the
+// writer may be overwriting them at the same time, followed by an acquire
+// fence and a load of `tail`. If `tail` has moved past the record, the copy
+// may be torn and is discarded; otherwise no word of it was overwritten. See
+// BipBufferLossyWriter.cpp for the writer's side of this protocol.
+
+BipBufferLossyReader::BipBufferLossyReader(BipBufferLossyHeader& layout)
+  : layout_(layout),
+    words_(layout.words()),
+    bufferSize_(layout.bufferSize),
+    position_(layout.tail.load(std::memory_order_relaxed)) {}
+
+std::optional<size_t> BipBufferLossyReader::read(void* data, size_t capacity) {
+  constexpr size_t HEADER_SIZE = BipBufferLossyHeader::RECORD_HEADER_SIZE;
+  constexpr size_t ALIGNMENT = BipBufferLossyHeader::RECORD_ALIGNMENT;
+
+  for (;;) {
+    const uint64_t head = layout_.head.load(std::memory_order_acquire);
+    if (position_ == head) { return std::nullopt; }
+    const uint64_t tail = layout_.tail.load(std::memory_order_relaxed);
+    if (position_ < tail) {
+      skipTo(tail);
+      continue;
+    }
+
+    // Copy the record. Its descriptor may be torn, so it is bounds checked
+    // before use and only trusted once `tail` has been checked
+    const size_t offset = size_t(position_ % bufferSize_);
+    const std::atomic<uint64_t>* word = words_ + offset / ALIGNMENT;
+    const uint64_t descriptor = (word++)->load(std::memory_order_relaxed);
+    const size_t span = BipBufferLossyHeader::RecordSpan(descriptor);
+    const bool padding = (descriptor & BipBufferLossyHeader::PADDING_FLAG) != 0;
+    const size_t length = BipBufferLossyHeader::RecordLength(descriptor);
+    const bool valid = span > 0 && span % ALIGNMENT == 0 && span <= bufferSize_ - offset &&
+      (padding || (span >= HEADER_SIZE && length <= span - HEADER_SIZE));
+
+    uint64_t sequence = 0;
+    if (valid && !padding) {
+      sequence = (word++)->load(std::memory_order_relaxed);
+      uint8_t* dst = static_cast<uint8_t*>(data);
+      size_t remaining = std::min(length, capacity);
+      for (; remaining > 0; ++word) {
+        const uint64_t value = word->load(std::memory_order_relaxed);
+        const size_t count = std::min(remaining, sizeof(uint64_t));
+        std::memcpy(dst, &value, count);
+        dst += count;
+        remaining -= count;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t newTail = layout_.tail.load(std::memory_order_relaxed);
+    if (position_ < newTail) {
+      // Lapped while copying, the copy may be torn
+      skipTo(newTail);
+      continue;
+    }
+    if (!valid) {
+      // An intact record can not be malformed unless the buffer is corrupt,
+      // resynchronize at the head
+      skipTo(head);
+      continue;
+    }
+
+    position_ += span;
+    if (padding) { continue; }
+    if (started_) { lostMessages_ += sequence - sequence_ - 1; }
+    sequence_ = sequence;
+    started_ = true;
+    return length;
+  }
+}
+
+void BipBufferLossyReader::skipTo(uint64_t position) {
+  lostBytes_ += position - position_;
+  position_ = position;
+}
+
+} // namespace mvi
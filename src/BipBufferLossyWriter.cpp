@@ -0,0 +1,82 @@
+#include "BipBufferLossyWriter.hpp"
+
+#include <cstring> // for memcpy
+
+namespace mvi {
+
+// Memory ordering: this follows the seqlock pattern. Before overwriting any
+// records, the writer stores the new `tail` and issues a release fence. A
+// reader copies a record with relaxed loads, issues an acquire fence and then
+// loads `tail`. If any word it copied was overwritten, the fences guarantee
+// that it sees the advanced `tail` and discards the copy. New records are
+// published by the release store of `head`, which pairs with the reader's
+// acquire load.
+
+BipBufferLossyWriter::BipBufferLossyWriter(BipBufferLossyHeader& layout)
+  : layout_(layout),
+    words_(layout.words()),
+    bufferSize_(layout.bufferSize),
+    head_(layout.head.load(std::memory_order_relaxed)),
+    tail_(layout.tail.load(std::memory_order_relaxed)),
+    sequence_(layout.sequence.load(std::memory_order_relaxed)) {}
+
+bool BipBufferLossyWriter::write(const void* data, size_t length) {
+  constexpr size_t HEADER_SIZE = BipBufferLossyHeader::RECORD_HEADER_SIZE;
+  constexpr size_t ALIGNMENT = BipBufferLossyHeader::RECORD_ALIGNMENT;
+  if (length > bufferSize_ - HEADER_SIZE) { return false; }
+  const size_t span = (HEADER_SIZE + length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+  // A record that does not fit before the end of the buffer is placed at the
+  // start, behind a padding record covering the rest of the buffer
+  const size_t offset = size_t(head_ % bufferSize_);
+  const size_t padding = span <= bufferSize_ - offset ? 0 : bufferSize_ - offset;
+  const uint64_t start = head_ + padding;
+  const uint64_t end = start + span;
+  if (end - tail_ > bufferSize_) {
+    evict(start, end);
+    layout_.tail.store(tail_, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  if (padding > 0) {
+    words_[offset / ALIGNMENT].store(
+      BipBufferLossyHeader::Descriptor(padding, 0, true), std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t>* word = words_ + size_t(start % bufferSize_) / ALIGNMENT;
+  (word++)->store(BipBufferLossyHeader::Descriptor(span, length, false), std::memory_order_relaxed);
+  (word++)->store(sequence_, std::memory_order_relaxed);
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t), src += sizeof(uint64_t)) {
+    uint64_t value;
+    std::memcpy(&value, src, sizeof(uint64_t));
+    (word++)->store(value, std::memory_order_relaxed);
+  }
+  if (length > 0) {
+    uint64_t value = 0;
+    std::memcpy(&value, src, length);
+    word->store(value, std::memory_order_relaxed);
+  }
+
+  head_ = end;
+  ++sequence_;
+  layout_.sequence.store(sequence_, std::memory_order_relaxed);
+  layout_.head.store(head_, std::memory_order_release);
+  return true;
+}
+
+void BipBufferLossyWriter::evict(uint64_t start, uint64_t end) {
+  // Walk the records from the tail until the new record no longer overlaps
+  // them. Only the padding record can remain between the head and `start`,
+  // and it is overwritten whole
+  while (end - tail_ > bufferSize_) {
+    if (tail_ == head_) {
+      tail_ = start;
+      return;
+    }
+    const size_t index = size_t(tail_ % bufferSize_) / BipBufferLossyHeader::RECORD_ALIGNMENT;
+    tail_ += BipBufferLossyHeader::RecordSpan(words_[index].load(std::memory_order_relaxed));
+  }
+}
+
+} // namespace mvi
@@ -0,0 +1,46 @@
+#include "BipBufferMpscHeader.hpp"
+
+#include <algorithm> // for min
+#include <cstring> // for memset
+#include <new> // IWYU pragma: keep (placement new)
+
+namespace mvi {
+
+const uint8_t* BipBufferMpscHeader::buffer() const {
+  return reinterpret_cast<const uint8_t*>(this) + sizeof(BipBufferMpscHeader);
+}
+
+uint8_t* BipBufferMpscHeader::buffer() {
+  return reinterpret_cast<uint8_t*>(this) + sizeof(BipBufferMpscHeader);
+}
+
+std::atomic<uint64_t>& BipBufferMpscHeader::record(size_t offset) {
+  return *reinterpret_cast<std::atomic<uint64_t>*>(buffer() + offset);
+}
+
+BipBufferMpscHeader* BipBufferMpscHeader::Create(uint8_t* data, size_t size) {
+  if (!data || size < sizeof(BipBufferMpscHeader) + 2 * RECORD_ALIGNMENT) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferMpscHeader) != 0) { return nullptr; }
+  // Explicitly using a raw pointer to indicate non-ownership
+  auto layout = new (data) BipBufferMpscHeader(); // NOLINT(cppcoreguidelines-owning-memory)
+  layout->magic = MAGIC;
+  layout->version = VERSION;
+  const size_t bufferSize = std::min(size - sizeof(BipBufferMpscHeader), MAX_BUFFER_SIZE);
+  layout->bufferSize = uint64_t(bufferSize - bufferSize % RECORD_ALIGNMENT);
+  std::memset(layout->buffer(), 0, layout->bufferSize);
+  layout->read = 0;
+  layout->claim = 0;
+  return layout;
+}
+
+BipBufferMpscHeader* BipBufferMpscHeader::Attach(uint8_t* data, size_t size) {
+  if (!data || size < sizeof(BipBufferMpscHeader) + 2 * RECORD_ALIGNMENT) { return nullptr; }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(BipBufferMpscHeader) != 0) { return nullptr; }
+  auto layout = reinterpret_cast<BipBufferMpscHeader*>(data);
+  if (layout->magic != MAGIC || layout->version != VERSION) { return nullptr; }
+  if (layout->bufferSize > size - sizeof(BipBufferMpscHeader)) { return nullptr; }
+  if (layout->bufferSize % RECORD_ALIGNMENT != 0) { return nullptr; }
+  return layout;
+}
+
+} // namespace mvi
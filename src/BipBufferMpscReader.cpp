@@ -0,0 +1,56 @@
+#include "BipBufferMpscReader.hpp"
+
+#include <cstring> // for memset
+
+namespace mvi {
+
+// Memory ordering: record header words are loaded with acquire ordering, which
+// pairs with the release store in BipBufferMpscReservation::commit() and makes
+// the payload written before that commit visible. Consumed records are zeroed
+// before `read` is stored with release ordering, so a writer that observes the
+// new read position also observes free space as zero, which is how the reader
+// recognizes a record that has been reserved but not committed yet.
+
+BipBufferMpscReader::BipBufferMpscReader(BipBufferMpscHeader& layout)
+  : layout_(layout),
+    bufferSize_(layout.bufferSize),
+    cachedRead_(layout.read.load(std::memory_order_relaxed)) {}
+
+size_t BipBufferMpscReader::position() const {
+  return size_t(cachedRead_);
+}
+
+std::optional<std::string_view> BipBufferMpscReader::read() {
+  for (;;) {
+    const size_t offset = size_t(cachedRead_ % bufferSize_);
+    const uint64_t header = layout_.record(offset).load(std::memory_order_acquire);
+    if (header == 0) {
+      peekedSpan_ = 0;
+      return std::nullopt;
+    }
+    if ((header & BipBufferMpscHeader::PADDING_FLAG) != 0) {
+      release(offset, BipBufferMpscHeader::RecordSpan(header));
+      continue;
+    }
+
+    peekedSpan_ = BipBufferMpscHeader::RecordSpan(header);
+    const char* data = reinterpret_cast<const char*>(
+      layout_.buffer() + offset + BipBufferMpscHeader::RECORD_HEADER_SIZE);
+    return std::string_view{data, BipBufferMpscHeader::RecordLength(header)};
+  }
+}
+
+bool BipBufferMpscReader::advance() {
+  if (peekedSpan_ == 0) { return false; }
+  release(size_t(cachedRead_ % bufferSize_), peekedSpan_);
+  peekedSpan_ = 0;
+  return true;
+}
+
+void BipBufferMpscReader::release(size_t offset, size_t span) {
+  std::memset(layout_.buffer() + offset, 0, span);
+  cachedRead_ += span;
+  layout_.read.store(cachedRead_, std::memory_order_release);
+}
+
+} // namespace mvi
@@ -0,0 +1,68 @@
+#include "BipBufferMpscReservation.hpp"
+
+#include "BipBufferMpscHeader.hpp"
+
+namespace mvi {
+
+BipBufferMpscReservation::BipBufferMpscReservation(
+  std::atomic<uint64_t>& record, size_t span, size_t length)
+  : record_(&record),
+    span_(span),
+    length_(length) {}
+
+BipBufferMpscReservation::~BipBufferMpscReservation() {
+  commit();
+}
+
+BipBufferMpscReservation::BipBufferMpscReservation(BipBufferMpscReservation&& other) noexcept
+  : record_(other.record_),
+    span_(other.span_),
+    length_(other.length_),
+    canceled_(other.canceled_) {
+  other.record_ = nullptr;
+}
+
+BipBufferMpscReservation& BipBufferMpscReservation::operator=(
+  BipBufferMpscReservation&& other) noexcept {
+  if (this != &other) {
+    commit(); // Commit the current reservation if one is held
+    record_ = other.record_;
+    span_ = other.span_;
+    length_ = other.length_;
+    canceled_ = other.canceled_;
+    other.record_ = nullptr;
+  }
+  return *this;
+}
+
+uint8_t* BipBufferMpscReservation::data() {
+  return reinterpret_cast<uint8_t*>(record_) + BipBufferMpscHeader::RECORD_HEADER_SIZE;
+}
+
+size_t BipBufferMpscReservation::size() const {
+  return canceled_ ? 0 : length_;
+}
+
+bool BipBufferMpscReservation::truncate(size_t newSize) {
+  if (newSize > size()) { return false; }
+  length_ = newSize;
+  return true;
+}
+
+void BipBufferMpscReservation::cancel() {
+  canceled_ = true;
+}
+
+void BipBufferMpscReservation::commit() {
+  // Storing a non-zero header word with release ordering publishes the payload
+  // written through data() to the reader, which loads the header with acquire
+  if (record_) {
+    const size_t length = canceled_ ? 0 : length_;
+    record_->store(BipBufferMpscHeader::RecordHeader(span_, length, canceled_),
+      std::memory_order_release);
+  }
+  record_ = nullptr;
+  canceled_ = false;
+}
+
+} // namespace mvi
@@ -0,0 +1,41 @@
+#include "BipBufferMpscWriter.hpp"
+
+namespace mvi {
+
+// Memory ordering: `claim` only hands out space, it does not publish any data,
+// so it is loaded and advanced with relaxed ordering. `read` is loaded with
+// acquire ordering, which pairs with the reader's release store in
+// BipBufferMpscReader::advance() and guarantees that the reader has finished
+// with, and zeroed, the space before a writer reuses it. Records are published
+// individually by the release store of their header word in
+// BipBufferMpscReservation::commit().
+
+BipBufferMpscWriter::BipBufferMpscWriter(BipBufferMpscHeader& layout)
+  : layout_(layout),
+    bufferSize_(layout.bufferSize) {}
+
+BipBufferMpscReservation BipBufferMpscWriter::reserve(size_t length) {
+  constexpr size_t HEADER_SIZE = BipBufferMpscHeader::RECORD_HEADER_SIZE;
+  constexpr size_t ALIGNMENT = BipBufferMpscHeader::RECORD_ALIGNMENT;
+  if (length > bufferSize_ - HEADER_SIZE) { return {}; }
+  const size_t span = (HEADER_SIZE + length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+  uint64_t claim = layout_.claim.load(std::memory_order_relaxed);
+  for (;;) {
+    // A record that does not fit before the end of the buffer is placed at the
+    // start, and the rest of the buffer is claimed along with it as padding
+    const size_t offset = size_t(claim % bufferSize_);
+    const size_t padding = span <= bufferSize_ - offset ? 0 : bufferSize_ - offset;
+    const uint64_t next = claim + padding + span;
+    if (next - layout_.read.load(std::memory_order_acquire) > bufferSize_) { return {}; }
+    if (layout_.claim.compare_exchange_weak(
+          claim, next, std::memory_order_relaxed, std::memory_order_relaxed)) {
+      if (padding == 0) { return {layout_.record(offset), span, length}; }
+      layout_.record(offset).store(
+        BipBufferMpscHeader::RecordHeader(padding, 0, true), std::memory_order_release);
+      return {layout_.record(0), span, length};
+    }
+  }
+}
+
+} // namespace mvi
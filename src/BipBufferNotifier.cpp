@@ -0,0 +1,101 @@
+#include "BipBufferNotifier.hpp"
+
+#if defined(__linux__)
+#include <errno.h> // errno
+#include <fcntl.h> // ::fcntl()
+#include <sys/eventfd.h> // ::eventfd()
+#include <unistd.h> // ::read(), ::write(), ::close()
+#endif
+
+namespace mvi {
+
+BipBufferNotifier::~BipBufferNotifier() {
+  close();
+}
+
+BipBufferNotifier::BipBufferNotifier(BipBufferNotifier&& other) noexcept
+  : fd_(other.fd_) {
+  other.fd_ = -1;
+}
+
+BipBufferNotifier& BipBufferNotifier::operator=(BipBufferNotifier&& other) noexcept {
+  if (this != &other) {
+    close(); // Close current file descriptor if open
+    fd_ = other.fd_;
+    other.fd_ = -1;
+  }
+  return *this;
+}
+
+#if defined(__linux__)
+
+std::optional<std::system_error> BipBufferNotifier::create() {
+  close();
+  fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd_ < 0) { return std::system_error(errno, std::system_category(), "eventfd"); }
+  return {};
+}
+
+std::optional<std::system_error> BipBufferNotifier::adopt(int fd) {
+  close();
+  if (fd < 0) { return std::system_error(EBADF, std::system_category(), "invalid descriptor"); }
+  // The descriptor may have been received without O_NONBLOCK set
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-vararg)
+  const int flags = ::fcntl(fd, F_GETFL);
+  if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+    return std::system_error(errno, std::system_category(), "fcntl");
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-vararg)
+  fd_ = fd;
+  return {};
+}
+
+void BipBufferNotifier::signal() const {
+  if (fd_ < 0) { return; }
+  // Fails only if the counter would overflow, in which case it is readable anyway
+  const uint64_t one = 1;
+  (void)::write(fd_, &one, sizeof(one));
+}
+
+uint64_t BipBufferNotifier::drain() const {
+  if (fd_ < 0) { return 0; }
+  uint64_t count = 0;
+  if (::read(fd_, &count, sizeof(count)) != sizeof(count)) { return 0; }
+  return count;
+}
+
+std::optional<std::system_error> BipBufferNotifier::close() {
+  const int fd = fd_;
+  fd_ = -1;
+  if (fd >= 0 && ::close(fd) == -1) {
+    return std::system_error(errno, std::system_category(), "close");
+  }
+  return {};
+}
+
+#else
+
+std::optional<std::system_error> BipBufferNotifier::create() {
+  return std::system_error(
+    std::make_error_code(std::errc::function_not_supported), "eventfd is not available");
+}
+
+std::optional<std::system_error> BipBufferNotifier::adopt(int) {
+  return std::system_error(
+    std::make_error_code(std::errc::function_not_supported), "eventfd is not available");
+}
+
+void BipBufferNotifier::signal() const {}
+
+uint64_t BipBufferNotifier::drain() const {
+  return 0;
+}
+
+std::optional<std::system_error> BipBufferNotifier::close() {
+  fd_ = -1;
+  return {};
+}
+
+#endif
+
+} // namespace mvi
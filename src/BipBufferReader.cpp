@@ -1,56 +1,237 @@
 #include "BipBufferReader.hpp"
+#include "BipBufferStatistics.hpp"
+
+#include <thread>
 
 namespace mvi {
 
+// Memory ordering: the reader is the only thread that stores `read`, so it
+// loads its own index with relaxed ordering. `write` is loaded with acquire
+// ordering, which pairs with the writer's release store in
+// BipBufferWriter::commit() and makes both the committed bytes and the `last`
+// value stored before that commit visible. `last` is therefore loaded relaxed
+// after `write`: the writer cannot store a newer `last` until it wraps again,
+// which requires the reader to first publish a `read` position past the
+// current `last`. `read` is stored with release ordering so that the reader's
+// accesses to consumed bytes happen-before the writer reuses that space.
+// Kernel wakeups use the handshake described in BipBufferWriter.cpp, and so
+// do growth requests. A mirrored buffer never loads `last`. Statistics
+// counters on the reader's line are only written by the reader, see
+// BipBufferStatistics.cpp.
+
 BipBufferReader::BipBufferReader(BipBufferHeader& layout)
-  : layout_(layout),
-    cachedRead_(layout.read.load(std::memory_order_seq_cst)),
-    cachedWrite_(layout.write.load(std::memory_order_seq_cst)),
-    cachedLast_(layout.last.load(std::memory_order_seq_cst)) {}
+  : read_(layout.read),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    cachedRead_(layout.read.load(std::memory_order_relaxed)),
+    cachedWrite_(layout.write.load(std::memory_order_acquire)),
+    cachedLast_(layout.last.load(std::memory_order_relaxed)) {}
+
+BipBufferReader::BipBufferReader(BipBufferHeaderV2& layout)
+  : read_(layout.read),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    cachedRead_(layout.read.load(std::memory_order_relaxed)),
+    cachedWrite_(layout.write.load(std::memory_order_acquire)),
+    cachedLast_(layout.last.load(std::memory_order_relaxed)) {
+  if ((layout.flags & BipBufferHeaderV2::FLAG_MIRRORED) != 0) {
+    mirrorSize_ = size_t(layout.bufferSize);
+  } else {
+    growable_ = &layout;
+  }
+  if ((layout.flags & BipBufferHeaderV2::FLAG_WAKEUPS) != 0) {
+    readerWaiting_ = &layout.readerWaiting;
+    writerWaiting_ = &layout.writerWaiting;
+    lightWakeFence_ = PrepareWakeFences();
+  }
+  statistics_ = layout.statistics();
+}
+
+BipBufferReader::BipBufferReader(BipBufferBroadcastHeader& layout, size_t slot)
+  : read_(layout.readers[slot].read),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    cachedRead_(0),
+    cachedWrite_(0),
+    cachedLast_(0),
+    joining_(true) {}
+
+bool BipBufferReader::join() {
+  // Acquire ordering pairs with the writer's release when admitting the
+  // reader, so the `write` loaded next is at least the admitted position
+  const uint64_t position = read_.load(std::memory_order_acquire);
+  if (position >= BipBufferBroadcastHeader::JOINING) { return false; }
+  cachedRead_ = size_t(position);
+  cachedWrite_ = cachedRead_;
+  joining_ = false;
+  return true;
+}
 
 size_t BipBufferReader::offset() const {
-  return layout_.read.load(std::memory_order_seq_cst);
+  return read_.load(std::memory_order_relaxed);
+}
+
+size_t BipBufferReader::mirroredAvailable() const {
+  return cachedWrite_ >= cachedRead_ ? cachedWrite_ - cachedRead_
+                                     : mirrorSize_ - (cachedRead_ - cachedWrite_);
+}
+
+size_t BipBufferReader::pendingGrowth() const {
+  if (!growable_) { return 0; }
+  const uint32_t generation = growable_->generation.load(std::memory_order_acquire);
+  if (generation == growable_->acknowledgedGeneration.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+  return growable_->bufferOffset + size_t(growable_->requestedSize.load(std::memory_order_relaxed));
+}
+
+void BipBufferReader::acknowledgeGrowth() {
+  if (!growable_) { return; }
+  const uint32_t generation = growable_->generation.load(std::memory_order_acquire);
+  growable_->acknowledgedSize.store(
+    growable_->requestedSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  growable_->acknowledgedGeneration.store(generation, std::memory_order_release);
 }
 
 std::string_view BipBufferReader::read() {
-  cachedWrite_ = layout_.write.load(std::memory_order_seq_cst);
+  if (joining_ && !join()) { return {}; }
+  cachedWrite_ = write_.load(std::memory_order_acquire);
+
+  if (mirrorSize_ > 0) {
+    // Data wrapping around the end of the buffer continues into the mirror
+    const char* data = reinterpret_cast<const char*>(&buffer_[cachedRead_]);
+    return std::string_view{data, mirroredAvailable()};
+  }
 
   if (cachedWrite_ >= cachedRead_) {
     // No wraparound
-    const char* data = reinterpret_cast<const char*>(&layout_.buffer()[cachedRead_]);
+    const char* data = reinterpret_cast<const char*>(&buffer_[cachedRead_]);
     return std::string_view{data, cachedWrite_ - cachedRead_};
   } else {
-    cachedLast_ = layout_.last.load(std::memory_order_seq_cst);
+    cachedLast_ = last_.load(std::memory_order_relaxed);
     if (cachedRead_ == cachedLast_) {
       cachedRead_ = 0;
       return read();
     }
 
     // Wraparound case
-    const char* data = reinterpret_cast<const char*>(&layout_.buffer()[cachedRead_]);
+    const char* data = reinterpret_cast<const char*>(&buffer_[cachedRead_]);
     return std::string_view{data, cachedLast_ - cachedRead_};
   }
 }
 
+std::string_view BipBufferReader::read(WaitStrategy strategy, std::chrono::nanoseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (uint32_t attempt = 0;; ++attempt) {
+    std::string_view data = read();
+    if (!data.empty()) { return data; }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) { return {}; }
+
+    if (strategy == WaitStrategy::BusySpin) { continue; }
+    if (strategy == WaitStrategy::SpinPause || attempt < WAIT_SPIN_COUNT) {
+      CpuRelax();
+      continue;
+    }
+    if (!readerWaiting_) {
+      // The writer does not wake us, fall back to yielding
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Announce that we are going to sleep, then check once more for data the
+    // writer may have published before it could see the announcement
+    constexpr uint32_t SLEEPING = BipBufferHeaderV2::WAIT_SLEEPING;
+    readerWaiting_->store(SLEEPING, std::memory_order_relaxed);
+    SleepFence();
+    data = read();
+    if (data.empty()) { FutexWait(*readerWaiting_, SLEEPING, deadline - now); }
+    readerWaiting_->store(0, std::memory_order_relaxed);
+    if (!data.empty()) { return data; }
+  }
+}
+
+bool BipBufferReader::arm() {
+  if (!readerWaiting_) { return false; }
+  // Same handshake as a sleeping read(), the writer signals the notifier
+  // instead of waking a futex
+  readerWaiting_->store(BipBufferHeaderV2::WAIT_NOTIFY, std::memory_order_relaxed);
+  SleepFence();
+  if (read().empty()) { return true; }
+  readerWaiting_->store(0, std::memory_order_relaxed);
+  return false;
+}
+
+std::array<std::string_view, 2> BipBufferReader::readAll() {
+  if (mirrorSize_ > 0) { return {read(), std::string_view{}}; }
+  if (joining_ && !join()) { return {}; }
+  cachedWrite_ = write_.load(std::memory_order_acquire);
+
+  if (cachedWrite_ < cachedRead_) {
+    cachedLast_ = last_.load(std::memory_order_relaxed);
+    if (cachedRead_ == cachedLast_) {
+      // The tail has been fully consumed, only the head remains
+      cachedRead_ = 0;
+    } else {
+      // Wraparound case: the tail from `read` to `last`, then the head up to `write`
+      const char* tail = reinterpret_cast<const char*>(&buffer_[cachedRead_]);
+      const char* head = reinterpret_cast<const char*>(buffer_);
+      return {std::string_view{tail, cachedLast_ - cachedRead_},
+        std::string_view{head, cachedWrite_}};
+    }
+  }
+
+  // No wraparound
+  const char* data = reinterpret_cast<const char*>(&buffer_[cachedRead_]);
+  return {std::string_view{data, cachedWrite_ - cachedRead_}, std::string_view{}};
+}
+
 bool BipBufferReader::advance(size_t count) {
-  if (cachedWrite_ >= cachedRead_) {
+  if (joining_) { return false; }
+  if (mirrorSize_ > 0) {
+    if (count > mirroredAvailable()) { return false; }
+    cachedRead_ += count;
+    if (cachedRead_ >= mirrorSize_) { cachedRead_ -= mirrorSize_; }
+  } else if (cachedWrite_ >= cachedRead_) {
     if (count <= cachedWrite_ - cachedRead_) {
       cachedRead_ += count;
     } else {
       return false;
     }
   } else {
+    // Consume from the tail, continuing into the head if `count` covers the
+    // whole tail
     const size_t remaining = cachedLast_ - cachedRead_;
-    if (count == remaining) {
-      cachedRead_ = 0;
-    } else if (count <= remaining) {
+    if (count < remaining) {
       cachedRead_ += count;
+    } else if (count - remaining <= cachedWrite_) {
+      cachedRead_ = count - remaining;
     } else {
       return false;
     }
   }
 
-  layout_.read.store(cachedRead_, std::memory_order_seq_cst);
+  read_.store(cachedRead_, std::memory_order_release);
+  if (statistics_) {
+    BipBufferStatistics::Add(statistics_->bytesConsumed, count);
+    BipBufferStatistics::Add(statistics_->advances, 1);
+  }
+  if (durability_ != Durability::None) {
+    // A failed flush only means that more data is read again after a crash
+    (void)SyncMemory(&read_, sizeof(read_), durability_);
+  }
+
+  // Wake the writer if it is sleeping in the kernel
+  if (writerWaiting_) {
+    WakeFence(lightWakeFence_);
+    if (writerWaiting_->load(std::memory_order_relaxed) != 0) {
+      writerWaiting_->store(0, std::memory_order_relaxed);
+      FutexWake(*writerWaiting_);
+    }
+  }
   return true;
 }
 
@@ -0,0 +1,25 @@
+#include "BipBufferStatistics.hpp"
+
+namespace mvi {
+
+// Memory ordering: every counter has a single writer that updates it with a
+// relaxed load and store, so increments are never lost without a locked
+// read-modify-write. Observers load the counters with relaxed ordering. A
+// counter therefore never appears to go backwards. It carries no ordering
+// relative to the buffer contents or positions, and the snapshot may mix
+// older and newer values of different counters.
+
+BipBufferStatistics::Counters BipBufferStatistics::load() const {
+  Counters counters{};
+  counters.bytesCommitted = bytesCommitted.load(std::memory_order_relaxed);
+  counters.messagesCommitted = messagesCommitted.load(std::memory_order_relaxed);
+  counters.reserveFailures = reserveFailures.load(std::memory_order_relaxed);
+  counters.wraps = wraps.load(std::memory_order_relaxed);
+  counters.wastedBytes = wastedBytes.load(std::memory_order_relaxed);
+  counters.highWaterMark = highWaterMark.load(std::memory_order_relaxed);
+  counters.bytesConsumed = bytesConsumed.load(std::memory_order_relaxed);
+  counters.advances = advances.load(std::memory_order_relaxed);
+  return counters;
+}
+
+} // namespace mvi
@@ -0,0 +1,119 @@
+#include "BipBufferWait.hpp"
+
+#include <algorithm> // for min
+#include <thread>
+
+#if defined(__linux__)
+#include <climits>
+
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace mvi {
+
+void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+#if defined(__linux__)
+
+// Shared (not FUTEX_PRIVATE_FLAG) futexes, since the word may be mapped into
+// several processes
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts{};
+  ts.tv_sec = time_t(seconds.count());
+  ts.tv_nsec = long((timeout - seconds).count());
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// membarrier() makes every other running thread execute a full memory barrier,
+// which lets the sleeping side pay for the fence the waking side would need on
+// every publish. The expedited command interrupts only the CPUs running
+// registered processes and takes microseconds, the plain one waits for an RCU
+// grace period, but neither is called unless a thread is about to sleep
+enum class SleepBarrier {
+  Fence, // No membarrier(), both sides issue sequentially consistent fences
+  Global, // MEMBARRIER_CMD_GLOBAL
+  GlobalExpedited, // MEMBARRIER_CMD_GLOBAL_EXPEDITED, after registering the process
+};
+
+static SleepBarrier DetectSleepBarrier() {
+  const long commands = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+  if (commands < 0) { return SleepBarrier::Fence; }
+  constexpr long EXPEDITED =
+    MEMBARRIER_CMD_GLOBAL_EXPEDITED | MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED;
+  if ((commands & EXPEDITED) == EXPEDITED &&
+      syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED, 0, 0) == 0) {
+    return SleepBarrier::GlobalExpedited;
+  }
+  if ((commands & MEMBARRIER_CMD_GLOBAL) != 0) { return SleepBarrier::Global; }
+  return SleepBarrier::Fence;
+}
+
+static SleepBarrier GetSleepBarrier() {
+  static const SleepBarrier barrier = DetectSleepBarrier();
+  return barrier;
+}
+
+bool PrepareWakeFences() {
+  return GetSleepBarrier() != SleepBarrier::Fence;
+}
+
+void SleepFence() {
+  const SleepBarrier barrier = GetSleepBarrier();
+  if (barrier == SleepBarrier::GlobalExpedited &&
+      syscall(SYS_membarrier, MEMBARRIER_CMD_GLOBAL_EXPEDITED, 0, 0) == 0) {
+    return;
+  }
+  if (barrier != SleepBarrier::Fence && syscall(SYS_membarrier, MEMBARRIER_CMD_GLOBAL, 0, 0) == 0) {
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+#else
+
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+  // No cross-process wait on address primitive, poll with short sleeps
+  constexpr std::chrono::nanoseconds POLL_INTERVAL = std::chrono::microseconds(100);
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::sleep_for(std::min(timeout, POLL_INTERVAL));
+  }
+}
+
+void FutexWake(std::atomic<uint32_t>&) {}
+
+// Without membarrier() both sides issue sequentially consistent fences
+bool PrepareWakeFences() {
+  return false;
+}
+
+void SleepFence() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+#endif
+
+} // namespace mvi
@@ -1,71 +1,486 @@
 #include "BipBufferWriter.hpp"
+#include "BipBufferStatistics.hpp"
+
+#include <algorithm> // for max, min
+#include <cstdint>
+#include <thread>
 
 namespace mvi {
 
+// Memory ordering: the writer is the only thread that stores `write` and
+// `last`, so it keeps them in `cachedWrite_` and `cachedLast_` and never loads
+// them from the header after construction. `read` is loaded with acquire
+// ordering, which pairs with the reader's release store in
+// BipBufferReader::advance() so the reader has finished with the consumed bytes
+// before they are overwritten. `write` is published with release ordering after
+// the reserved bytes and `last` have been written, which pairs with the
+// reader's acquire load of `write`.
+//
+// With a broadcast header every reader cursor is loaded with acquire ordering
+// for the same reason. Joining readers are admitted before `write` is
+// published, so the release store of `write` also publishes their cursors.
+//
+// Kernel wakeups follow the usual futex handshake: the side going to sleep
+// sets its wait word, issues SleepFence() and checks the other side's position
+// once more, while the waker publishes its position, issues WakeFence() and
+// checks the wait word. The fences guarantee that at least one of them sees the
+// other's store, so a wakeup is never lost. The fences are asymmetric where
+// membarrier() is available: SleepFence() forces a full barrier on every
+// running thread, so WakeFence() only has to keep the compiler from reordering
+// the store and the load, and publishing costs no fence while nobody sleeps.
+//
+// A mirrored buffer uses the same orderings. It never wraps a reservation, so
+// `last` is neither stored nor loaded.
+//
+// Durability flushes are ordered by the file contents rather than by memory
+// ordering: committed bytes are flushed before `write` is stored, and the
+// header, which holds `read` as well, is flushed before space freed by the
+// reader is reused, so the persisted positions never cover bytes that were
+// not persisted or were already overwritten.
+//
+// Growth requests store `requestedSize` before bumping `generation` with
+// release ordering, which pairs with the reader's acquire load of
+// `generation`. The reader acknowledges with a release store of
+// `acknowledgedGeneration` once its mapping covers the larger buffer, which
+// pairs with the writer's acquire load before it writes past the old end.
+//
+// Statistics counters on the writer's line are only written by the writer, see
+// BipBufferStatistics.cpp. The occupancy high-water mark is computed from the
+// cached read position. That position may lag, so the mark can overstate the
+// true occupancy but never understate it, and the reader's line is not
+// touched to compute it.
+
+BipBufferWriter::BipBufferWriter(BipBufferHeader& layout)
+  : read_(&layout.read),
+    broadcast_(nullptr),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    bufferSize_(layout.bufferSize),
+    cachedRead_(layout.read.load(std::memory_order_acquire)),
+    cachedWrite_(layout.write.load(std::memory_order_relaxed)),
+    cachedLast_(layout.last.load(std::memory_order_relaxed)),
+    publishedLast_(cachedLast_),
+    header_(reinterpret_cast<const uint8_t*>(&layout)) {}
+
+BipBufferWriter::BipBufferWriter(BipBufferHeaderV2& layout)
+  : read_(&layout.read),
+    broadcast_(nullptr),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    bufferSize_(layout.acknowledgedSize.load(std::memory_order_acquire)),
+    cachedRead_(layout.read.load(std::memory_order_acquire)),
+    cachedWrite_(layout.write.load(std::memory_order_relaxed)),
+    cachedLast_(layout.last.load(std::memory_order_relaxed)),
+    publishedLast_(cachedLast_),
+    mirrored_((layout.flags & BipBufferHeaderV2::FLAG_MIRRORED) != 0),
+    header_(reinterpret_cast<const uint8_t*>(&layout)) {
+  if (!mirrored_) {
+    growable_ = &layout;
+    growing_ = layout.generation.load(std::memory_order_relaxed) !=
+               layout.acknowledgedGeneration.load(std::memory_order_relaxed);
+  }
+  if ((layout.flags & BipBufferHeaderV2::FLAG_WAKEUPS) != 0) {
+    readerWaiting_ = &layout.readerWaiting;
+    writerWaiting_ = &layout.writerWaiting;
+    lightWakeFence_ = PrepareWakeFences();
+  }
+  statistics_ = layout.statistics();
+}
+
+BipBufferWriter::BipBufferWriter(BipBufferBroadcastHeader& layout)
+  : read_(nullptr),
+    broadcast_(&layout),
+    write_(layout.write),
+    last_(layout.last),
+    buffer_(layout.buffer()),
+    bufferSize_(layout.bufferSize),
+    cachedRead_(0),
+    cachedWrite_(layout.write.load(std::memory_order_relaxed)),
+    cachedLast_(layout.last.load(std::memory_order_relaxed)),
+    publishedLast_(cachedLast_),
+    header_(reinterpret_cast<const uint8_t*>(&layout)) {
+  cachedRead_ = loadRead();
+}
+
+BipBufferWriter::~BipBufferWriter() {
+  flush();
+}
+
+BipBufferWriter::BipBufferWriter(BipBufferWriter&& other) noexcept
+  : read_(other.read_),
+    broadcast_(other.broadcast_),
+    write_(other.write_),
+    last_(other.last_),
+    buffer_(other.buffer_),
+    bufferSize_(other.bufferSize_),
+    cachedRead_(other.cachedRead_),
+    cachedWrite_(other.cachedWrite_),
+    cachedLast_(other.cachedLast_),
+    publishedLast_(other.publishedLast_),
+    mirrored_(other.mirrored_),
+    policy_(other.policy_),
+    pendingMessages_(other.pendingMessages_),
+    pendingBytes_(other.pendingBytes_),
+    pendingSince_(other.pendingSince_),
+    readerWaiting_(other.readerWaiting_),
+    writerWaiting_(other.writerWaiting_),
+    lightWakeFence_(other.lightWakeFence_),
+    notifier_(other.notifier_),
+    header_(other.header_),
+    durability_(other.durability_),
+    syncedWrite_(other.syncedWrite_),
+    durabilityError_(std::move(other.durabilityError_)),
+    growable_(other.growable_),
+    growing_(other.growing_),
+    statistics_(other.statistics_),
+    readRefreshed_(other.readRefreshed_) {
+  // The moved-from writer must not publish its stale positions on destruction
+  other.pendingMessages_ = 0;
+  other.pendingBytes_ = 0;
+}
+
 static size_t SaturatingSub(size_t x, size_t y) {
   size_t res = x - y;
   res &= -(res <= x);
   return res;
 }
 
-std::unique_ptr<BipBufferWriterReservation> BipBufferWriter::reserve(size_t length) {
-  // First, determine whether there is enough space to reserve `length` bytes
-  const size_t currentWrite = layout_.write.load(std::memory_order_seq_cst);
-  const size_t currentRead = layout_.read.load(std::memory_order_seq_cst);
-
-  size_t start;
-  bool wraparound = false;
-  if (currentWrite >= currentRead) {
+bool BipBufferWriter::findSpace(size_t length, size_t& start, bool& wraparound) const {
+  wraparound = false;
+  if (mirrored_) {
+    // All free space is contiguous, it continues into the mirror past the end
+    // of the buffer. One byte is kept free to differentiate from an empty buffer
+    // [----W.....................R--------]
+    const size_t used = cachedWrite_ >= cachedRead_
+                          ? cachedWrite_ - cachedRead_
+                          : bufferSize_ - (cachedRead_ - cachedWrite_);
+    if (bufferSize_ - used - 1 < length) { return false; }
+    start = cachedWrite_;
+    return true;
+  }
+  if (cachedWrite_ >= cachedRead_) {
     // Case 1: There is space from write to the end or from start to read
     // [R.........W------------------------] or
     // [---------------------------R....W--]
-    size_t endSpace = SaturatingSub(layout_.bufferSize, currentWrite);
+    size_t endSpace = SaturatingSub(bufferSize_, cachedWrite_);
     if (endSpace >= length) {
-      start = currentWrite; // Start writing at `currentWrite`
+      start = cachedWrite_; // Start writing at `cachedWrite_`
     } else {
-      if (SaturatingSub(currentRead, 1) >= length) {
+      if (SaturatingSub(cachedRead_, 1) >= length) {
         start = 0; // Start writing at the beginning of the buffer
         wraparound = true;
       } else {
-        return nullptr; // Not enough space
+        return false; // Not enough space
       }
     }
   } else {
     // Case 2: There is space from write to read
     // [....W--------------R................]
     // Ensure there's a gap of at least one byte to differentiate from a full buffer
-    if (SaturatingSub(currentRead - currentWrite, 1) >= length) {
-      start = currentWrite;
+    if (SaturatingSub(cachedRead_ - cachedWrite_, 1) >= length) {
+      start = cachedWrite_;
     } else {
-      return nullptr; // Not enough space
+      return false; // Not enough space
+    }
+  }
+  return true;
+}
+
+size_t BipBufferWriter::largestSpace() const {
+  if (mirrored_) {
+    const size_t used = cachedWrite_ >= cachedRead_
+                          ? cachedWrite_ - cachedRead_
+                          : bufferSize_ - (cachedRead_ - cachedWrite_);
+    return bufferSize_ - used - 1;
+  }
+  if (cachedWrite_ >= cachedRead_) {
+    // The larger of the space at the end and the space before `read`, which
+    // findSpace() picks in that order
+    return std::max(SaturatingSub(bufferSize_, cachedWrite_), SaturatingSub(cachedRead_, 1));
+  }
+  return SaturatingSub(cachedRead_ - cachedWrite_, 1);
+}
+
+void BipBufferWriter::refreshRead() {
+  cachedRead_ = loadRead();
+  readRefreshed_ = true;
+  // Persist the reader's position before the space it freed is overwritten
+  if (durability_ != Durability::None) { syncHeader(); }
+  // A growth acknowledged by the reader may provide the missing space
+  if (growing_) { adoptGrowth(); }
+}
+
+BipBufferWriterReservation BipBufferWriter::reserve(size_t length) {
+  // Enforce the latency limit of a pending batch before reserving more space
+  if (pendingMessages_ > 0 && policy_.maxLatency > std::chrono::nanoseconds::zero() &&
+      std::chrono::steady_clock::now() - pendingSince_ >= policy_.maxLatency) {
+    publish();
+  }
+
+  // First, determine whether there is enough space to reserve `length` bytes.
+  // The cached read position only ever lags behind the reader, so it can
+  // underestimate the free space but never overestimate it. Only when it
+  // reports too little space is the reader's cache line touched to refresh it
+  size_t start;
+  bool wraparound;
+  if (!findSpace(length, start, wraparound)) {
+    refreshRead();
+    if (!findSpace(length, start, wraparound)) {
+      // Unpublished commits may be what is filling the buffer, publish them so
+      // the reader can make room
+      flush();
+      if (statistics_) { BipBufferStatistics::Add(statistics_->reserveFailures, 1); }
+      return {};
     }
   }
 
   // Reserve the space (note: actual commit happens when the reservation goes
   // out of scope)
-  return std::make_unique<BipBufferWriterReservation>(*this, start, length, wraparound);
+  return BipBufferWriterReservation{*this, start, length, wraparound};
+}
+
+BipBufferWriterReservation BipBufferWriter::reserveAtMost(size_t maxLength) {
+  if (maxLength == 0) { return {}; }
+  // Settle for less than `maxLength` only once the read position is fresh
+  size_t length = std::min(largestSpace(), maxLength);
+  if (length < maxLength) {
+    refreshRead();
+    length = std::min(largestSpace(), maxLength);
+    if (length == 0) {
+      flush();
+      if (statistics_) { BipBufferStatistics::Add(statistics_->reserveFailures, 1); }
+      return {};
+    }
+  }
+  return reserve(length);
+}
+
+BipBufferWriterReservation BipBufferWriter::reserve(
+  size_t length, WaitStrategy strategy, std::chrono::nanoseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (uint32_t attempt = 0;; ++attempt) {
+    auto reservation = reserve(length);
+    if (reservation) { return reservation; }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) { return {}; }
+
+    if (strategy == WaitStrategy::BusySpin) { continue; }
+    if (strategy == WaitStrategy::SpinPause || attempt < WAIT_SPIN_COUNT) {
+      CpuRelax();
+      continue;
+    }
+    if (!writerWaiting_) {
+      // The reader does not wake us, fall back to yielding
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Announce that we are going to sleep, then check once more for space the
+    // reader may have freed before it could see the announcement
+    constexpr uint32_t SLEEPING = BipBufferHeaderV2::WAIT_SLEEPING;
+    writerWaiting_->store(SLEEPING, std::memory_order_relaxed);
+    SleepFence();
+    reservation = reserve(length);
+    if (!reservation) { FutexWait(*writerWaiting_, SLEEPING, deadline - now); }
+    writerWaiting_->store(0, std::memory_order_relaxed);
+    if (reservation) { return reservation; }
+  }
 }
 
 void BipBufferWriter::commit(size_t start, size_t length, bool wraparound) {
   if (length == 0) { return; }
 
-  const size_t currentWrite = layout_.write.load(std::memory_order_seq_cst);
-  const size_t newWrite = start + length;
+  size_t newWrite = start + length;
 
-  // Commit the reserved space: update the `last` and `write` positions
+  // Commit the reserved space: update the local `last` and `write` positions
 
-  if (wraparound) {
+  if (mirrored_) {
+    // Data written into the mirror landed at the start of the buffer
+    if (newWrite >= bufferSize_) { newWrite -= bufferSize_; }
+  } else if (wraparound) {
     // If the reservation involved a wraparound, update `last` to point to the
     // end of the last committed write
-    layout_.last.store(currentWrite, std::memory_order_seq_cst);
-  } else {
+    cachedLast_ = cachedWrite_;
+  } else if (newWrite > cachedLast_) {
     // No wraparound, only update `last` if the new `write` position extends
     // beyond it
-    const size_t currentLast = layout_.last.load(std::memory_order_seq_cst);
-    if (newWrite > currentLast) { layout_.last.store(newWrite, std::memory_order_seq_cst); }
+    cachedLast_ = newWrite;
+  }
+  cachedWrite_ = newWrite;
+  if (statistics_) { countCommit(length, wraparound); }
+
+  // Publish according to the batching policy. The clock is only read when a
+  // latency limit is set
+  const bool timed = policy_.maxLatency > std::chrono::nanoseconds::zero();
+  std::chrono::steady_clock::time_point now;
+  if (timed) {
+    now = std::chrono::steady_clock::now();
+    if (pendingMessages_ == 0) { pendingSince_ = now; }
   }
+  ++pendingMessages_;
+  pendingBytes_ += length;
 
-  layout_.write.store(newWrite, std::memory_order_seq_cst);
+  if ((policy_.maxMessages > 0 && pendingMessages_ >= policy_.maxMessages) ||
+      (policy_.maxBytes > 0 && pendingBytes_ >= policy_.maxBytes) ||
+      (timed && now - pendingSince_ >= policy_.maxLatency)) {
+    publish();
+  }
+}
+
+void BipBufferWriter::countCommit(size_t length, bool wraparound) {
+  BipBufferStatistics::Add(statistics_->bytesCommitted, length);
+  BipBufferStatistics::Add(statistics_->messagesCommitted, 1);
+  if (wraparound) {
+    // The data before the wraparound ends at `last`, the rest is skipped
+    BipBufferStatistics::Add(statistics_->wraps, 1);
+    BipBufferStatistics::Add(statistics_->wastedBytes, bufferSize_ - cachedLast_);
+  }
+
+  // A stale read position overstates the occupancy, so it is only sampled
+  // right after a reload, see BipBufferStatistics
+  if (!readRefreshed_) { return; }
+  readRefreshed_ = false;
+  size_t occupancy;
+  if (cachedWrite_ >= cachedRead_) {
+    occupancy = cachedWrite_ - cachedRead_;
+  } else if (mirrored_) {
+    occupancy = bufferSize_ - (cachedRead_ - cachedWrite_);
+  } else {
+    // The tail from `read` to `last`, then the head up to `write`
+    occupancy = cachedLast_ - cachedRead_ + cachedWrite_;
+  }
+  BipBufferStatistics::Raise(statistics_->highWaterMark, occupancy);
+}
+
+size_t BipBufferWriter::loadRead() const {
+  if (read_) { return read_->load(std::memory_order_acquire); }
+
+  // A reader positioned after the write position is still consuming the data
+  // before `last` and is behind every reader positioned at or before it. Within
+  // each group the reader with the lowest position is the slowest
+  size_t behind = SIZE_MAX; // Slowest reader after the write position
+  size_t current = SIZE_MAX; // Slowest reader at or before the write position
+  for (const auto& cursor : broadcast_->readers) {
+    const uint64_t read = cursor.read.load(std::memory_order_acquire);
+    if (read >= BipBufferBroadcastHeader::JOINING) { continue; }
+    if (read > cachedWrite_) {
+      behind = std::min(behind, size_t(read));
+    } else {
+      current = std::min(current, size_t(read));
+    }
+  }
+  if (behind != SIZE_MAX) { return behind; }
+  if (current != SIZE_MAX) { return current; }
+  // Without readers the buffer is empty as of the published write position,
+  // which joining readers will start from
+  return write_.load(std::memory_order_relaxed);
+}
+
+void BipBufferWriter::admitReaders() {
+  const uint64_t position = write_.load(std::memory_order_relaxed);
+  for (auto& cursor : broadcast_->readers) {
+    uint64_t expected = BipBufferBroadcastHeader::JOINING;
+    if (cursor.read.compare_exchange_strong(
+          expected, position, std::memory_order_release, std::memory_order_relaxed)) {
+      broadcast_->joinRequests.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void BipBufferWriter::setNotifier(const BipBufferNotifier* notifier) {
+  notifier_ = notifier;
+}
+
+void BipBufferWriter::setBatchPolicy(const BatchPolicy& policy) {
+  flush();
+  policy_ = policy;
+}
+
+bool BipBufferWriter::grow(size_t bufferSize) {
+  if (!growable_ || growing_ || bufferSize <= bufferSize_) { return false; }
+  growable_->requestedSize.store(bufferSize, std::memory_order_relaxed);
+  growable_->generation.fetch_add(1, std::memory_order_release);
+  growing_ = true;
+  return true;
+}
+
+void BipBufferWriter::adoptGrowth() {
+  const uint32_t generation = growable_->generation.load(std::memory_order_relaxed);
+  if (growable_->acknowledgedGeneration.load(std::memory_order_acquire) != generation) { return; }
+  bufferSize_ = size_t(growable_->requestedSize.load(std::memory_order_relaxed));
+  growing_ = false;
+}
+
+void BipBufferWriter::setDurability(Durability durability) {
+  flush();
+  durability_ = durability;
+  if (durability_ == Durability::None) { return; }
+  syncedWrite_ = cachedWrite_;
+  const size_t length = size_t(buffer_ - header_) + bufferSize_;
+  if (auto err = SyncMemory(header_, length, durability_); err && !durabilityError_) {
+    durabilityError_ = std::move(err);
+  }
+}
+
+void BipBufferWriter::syncData() {
+  if (cachedWrite_ == syncedWrite_) { return; }
+  std::optional<std::system_error> err;
+  if (cachedWrite_ > syncedWrite_) {
+    err = SyncMemory(buffer_ + syncedWrite_, cachedWrite_ - syncedWrite_, durability_);
+  } else {
+    // The commits wrapped around: the tail up to the end of the data, then the head
+    const size_t end = mirrored_ ? bufferSize_ : cachedLast_;
+    err = SyncMemory(buffer_ + syncedWrite_, end - syncedWrite_, durability_);
+    if (!err) { err = SyncMemory(buffer_, cachedWrite_, durability_); }
+  }
+  if (err && !durabilityError_) { durabilityError_ = std::move(err); }
+  syncedWrite_ = cachedWrite_;
+}
+
+void BipBufferWriter::syncHeader() {
+  auto err = SyncMemory(header_, size_t(buffer_ - header_), durability_);
+  if (err && !durabilityError_) { durabilityError_ = std::move(err); }
+}
+
+void BipBufferWriter::flush() {
+  if (pendingMessages_ > 0) { publish(); }
+}
+
+void BipBufferWriter::publish() {
+  if (durability_ != Durability::None) { syncData(); }
+
+  // `last` only has to be stored when it changed, it is released together with
+  // the written bytes by the `write` store below
+  if (cachedLast_ != publishedLast_) {
+    last_.store(cachedLast_, std::memory_order_relaxed);
+    publishedLast_ = cachedLast_;
+  }
+
+  // Joining readers start at the previously published write position, so they
+  // receive the commits being published now
+  if (broadcast_ && broadcast_->joinRequests.load(std::memory_order_relaxed) != 0) {
+    admitReaders();
+  }
+
+  // Publish the new write position, releasing the written bytes and `last`
+  write_.store(cachedWrite_, std::memory_order_release);
+  pendingMessages_ = 0;
+  pendingBytes_ = 0;
+  if (durability_ != Durability::None) { syncHeader(); }
+
+  // Wake the reader if it is sleeping in the kernel or waiting for a
+  // notification. It only waits once it has found the buffer empty, so this
+  // signals the empty to non-empty transition
+  if (readerWaiting_) {
+    WakeFence(lightWakeFence_);
+    if (readerWaiting_->load(std::memory_order_relaxed) != 0) {
+      const uint32_t waiting = readerWaiting_->exchange(0, std::memory_order_relaxed);
+      if ((waiting & BipBufferHeaderV2::WAIT_SLEEPING) != 0) { FutexWake(*readerWaiting_); }
+      if ((waiting & BipBufferHeaderV2::WAIT_NOTIFY) != 0 && notifier_) { notifier_->signal(); }
+    }
+  }
 }
 
 } // namespace mvi
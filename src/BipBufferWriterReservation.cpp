@@ -6,19 +6,40 @@ namespace mvi {
 
 BipBufferWriterReservation::BipBufferWriterReservation(
   BipBufferWriter& writer, size_t start, size_t len, bool wraparound)
-  : writer_(writer),
+  : writer_(&writer),
     start_(start),
     length_(len),
     wraparound_(wraparound) {}
 
 BipBufferWriterReservation::~BipBufferWriterReservation() {
-  // If the reservation has not been canceled (len_ > 0), update the buffer's
-  // write index to commit this reservation
-  if (length_ > 0) { writer_.commit(start_, length_, wraparound_); }
+  commit();
+}
+
+BipBufferWriterReservation::BipBufferWriterReservation(BipBufferWriterReservation&& other) noexcept
+  : writer_(other.writer_),
+    start_(other.start_),
+    length_(other.length_),
+    wraparound_(other.wraparound_) {
+  other.writer_ = nullptr;
+  other.length_ = 0;
+}
+
+BipBufferWriterReservation& BipBufferWriterReservation::operator=(
+  BipBufferWriterReservation&& other) noexcept {
+  if (this != &other) {
+    commit(); // Commit the current reservation if one is held
+    writer_ = other.writer_;
+    start_ = other.start_;
+    length_ = other.length_;
+    wraparound_ = other.wraparound_;
+    other.writer_ = nullptr;
+    other.length_ = 0;
+  }
+  return *this;
 }
 
 uint8_t* BipBufferWriterReservation::data() {
-  return writer_.layout_.buffer() + start_;
+  return writer_->buffer_ + start_;
 }
 
 size_t BipBufferWriterReservation::size() const {
@@ -36,4 +57,12 @@ void BipBufferWriterReservation::cancel() {
   length_ = 0;
 }
 
+void BipBufferWriterReservation::commit() {
+  // If the reservation has not been canceled (len_ > 0), update the buffer's
+  // write index to commit this reservation
+  if (writer_ && length_ > 0) { writer_->commit(start_, length_, wraparound_); }
+  writer_ = nullptr;
+  length_ = 0;
+}
+
 } // namespace mvi
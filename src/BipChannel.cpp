@@ -0,0 +1,208 @@
+#include "BipChannel.hpp"
+
+#include <new> // IWYU pragma: keep (placement new)
+#include <thread>
+#include <utility> // for move
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <errno.h> // errno
+#include <signal.h> // ::kill()
+#include <unistd.h> // ::getpid()
+#endif // _WIN32
+
+// Memory ordering:
+// - The producer initializes the control block and the header, then publishes
+//   them with a release store of `state`. A consumer acquire-loads `state`
+//   before reading anything else, so it never sees a half-initialized header.
+//   Until then the area is either missing, has no size yet, or reads as zero.
+// - The PID fields are claimed and cleared with compare-exchange, so that a
+//   consumer taking over from one that exited can not race another consumer.
+
+namespace mvi {
+
+// How often attach() checks for the channel while waiting for it
+constexpr std::chrono::milliseconds ATTACH_POLL_INTERVAL{1};
+
+static uint32_t CurrentPid() {
+#ifdef _WIN32
+  return uint32_t(GetCurrentProcessId());
+#else
+  return uint32_t(::getpid());
+#endif
+}
+
+static bool ProcessAlive(uint32_t pid) {
+  if (pid == 0) { return false; }
+#ifdef _WIN32
+  HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, DWORD(pid));
+  if (!process) { return GetLastError() == ERROR_ACCESS_DENIED; }
+  const bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+  CloseHandle(process);
+  return alive;
+#else
+  // EPERM means the process exists but belongs to another user
+  return ::kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+BipChannel::BipChannel(const std::string& name)
+  : memory_(name, 0) {}
+
+BipChannel::~BipChannel() {
+  close();
+}
+
+BipChannel::BipChannel(BipChannel&& other) noexcept
+  : memory_(std::move(other.memory_)),
+    control_(other.control_),
+    header_(other.header_),
+    ownPid_(other.ownPid_) {
+  other.control_ = nullptr;
+  other.header_ = nullptr;
+  other.ownPid_ = nullptr;
+}
+
+BipChannel& BipChannel::operator=(BipChannel&& other) noexcept {
+  if (this != &other) {
+    close(); // Close current channel if open
+    memory_ = std::move(other.memory_);
+    control_ = other.control_;
+    header_ = other.header_;
+    ownPid_ = other.ownPid_;
+    other.control_ = nullptr;
+    other.header_ = nullptr;
+    other.ownPid_ = nullptr;
+  }
+  return *this;
+}
+
+std::optional<std::system_error> BipChannel::create(size_t bufferSize, uint32_t flags) {
+  close();
+  if (bufferSize == 0 || (flags & BipBufferHeaderV2::FLAG_MIRRORED) != 0) {
+    return std::system_error(std::make_error_code(std::errc::invalid_argument),
+      "channels need a buffer size and can not be mirrored");
+  }
+
+  // Only replace a channel that has been abandoned by its producer
+  const std::string name = memory_.name();
+  if (!open()) {
+    const bool alive = ProcessAlive(control_->producerPid.load(std::memory_order_relaxed));
+    close();
+    if (alive) {
+      return std::system_error(
+        std::make_error_code(std::errc::device_or_resource_busy), "channel has a producer");
+    }
+  }
+  if (auto err = SharedMemory::Destroy(name)) { return err; }
+
+  constexpr size_t headerOffset = sizeof(Control);
+  memory_ = SharedMemory(name, headerOffset + BipBufferHeaderV2::HeaderSize(flags) + bufferSize);
+  if (auto err = memory_.open(SharedMemory::Access::ReadWrite)) { return err; }
+
+  // The new area reads as zero, so `state` stays clear until the end
+  auto* data = memory_.as<uint8_t>();
+  auto* header =
+    BipBufferHeaderV2::Create(data + headerOffset, memory_.capacity() - headerOffset, flags);
+  if (!header) {
+    memory_.close();
+    return std::system_error(std::make_error_code(std::errc::invalid_argument), "header");
+  }
+  auto* control = new (data) Control(); // NOLINT(cppcoreguidelines-owning-memory)
+  control->magic = Control::MAGIC;
+  control->version = Control::VERSION;
+  control->headerOffset = uint32_t(headerOffset);
+  control->consumerPid.store(0, std::memory_order_relaxed);
+  control->producerPid.store(CurrentPid(), std::memory_order_relaxed);
+  control->state.store(Control::STATE_READY, std::memory_order_release);
+
+  control_ = control;
+  header_ = header;
+  ownPid_ = &control->producerPid;
+  return {};
+}
+
+std::optional<std::system_error> BipChannel::attach(std::chrono::milliseconds timeout) {
+  close();
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (;;) {
+    auto err = open();
+    if (!err) { break; }
+    // A missing or unsized area and a clear `state` mean the producer has not
+    // finished creating the channel yet
+    const bool pending = err->code() == std::errc::no_such_file_or_directory ||
+                         err->code() == std::errc::resource_unavailable_try_again;
+    if (!pending) { return err; }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return std::system_error(std::make_error_code(std::errc::timed_out), "channel not ready");
+    }
+    std::this_thread::sleep_for(ATTACH_POLL_INTERVAL);
+  }
+
+  // Claim the consumer slot, taking it over from a consumer that has exited
+  const uint32_t pid = CurrentPid();
+  uint32_t previous = 0;
+  while (!control_->consumerPid.compare_exchange_weak(
+    previous, pid, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    if (ProcessAlive(previous)) {
+      close();
+      return std::system_error(
+        std::make_error_code(std::errc::device_or_resource_busy), "channel has a consumer");
+    }
+  }
+  ownPid_ = &control_->consumerPid;
+  return {};
+}
+
+bool BipChannel::producerAlive() const {
+  return control_ && ProcessAlive(control_->producerPid.load(std::memory_order_relaxed));
+}
+
+bool BipChannel::consumerAlive() const {
+  return control_ && ProcessAlive(control_->consumerPid.load(std::memory_order_relaxed));
+}
+
+std::optional<std::system_error> BipChannel::close() {
+  if (ownPid_) {
+    uint32_t pid = CurrentPid();
+    ownPid_->compare_exchange_strong(pid, 0, std::memory_order_acq_rel);
+  }
+  control_ = nullptr;
+  header_ = nullptr;
+  ownPid_ = nullptr;
+  return memory_.close();
+}
+
+std::optional<std::system_error> BipChannel::open() {
+  // Without a size, SharedMemory opens the existing area and takes its size
+  memory_ = SharedMemory(memory_.name(), 0);
+  if (auto err = memory_.open(SharedMemory::Access::ReadWrite)) { return err; }
+
+  const auto invalid = [this] {
+    memory_.close();
+    return std::system_error(std::make_error_code(std::errc::protocol_error), "not a channel");
+  };
+  if (memory_.size() < sizeof(Control)) { return invalid(); }
+  auto* control = memory_.as<Control>();
+  if (control->state.load(std::memory_order_acquire) != Control::STATE_READY) {
+    memory_.close();
+    return std::system_error(
+      std::make_error_code(std::errc::resource_unavailable_try_again), "channel not ready");
+  }
+  if (control->magic != Control::MAGIC || control->version != Control::VERSION ||
+      control->headerOffset >= memory_.size()) {
+    return invalid();
+  }
+  auto* header = BipBufferHeaderV2::Attach(
+    memory_.as<uint8_t>() + control->headerOffset, memory_.size() - control->headerOffset);
+  if (!header) { return invalid(); }
+
+  control_ = control;
+  header_ = header;
+  return {};
+}
+
+} // namespace mvi
@@ -0,0 +1,43 @@
+#include "BipMessageReader.hpp"
+
+#include "BipMessageFrame.hpp"
+
+#include <cstring> // for memcpy
+
+namespace mvi {
+
+BipMessageBatch::Iterator::Iterator(
+  const std::array<std::string_view, 2>* spans, size_t span, size_t offset)
+  : spans_(spans),
+    span_(span),
+    offset_(offset) {
+  parse();
+}
+
+BipMessageBatch::Iterator& BipMessageBatch::Iterator::operator++() {
+  offset_ += BIP_MESSAGE_HEADER_SIZE + message_.size();
+  parse();
+  return *this;
+}
+
+void BipMessageBatch::Iterator::parse() {
+  while (span_ < spans_->size()) {
+    const std::string_view span = (*spans_)[span_];
+    if (offset_ <= span.size() && span.size() - offset_ >= BIP_MESSAGE_HEADER_SIZE) {
+      BipMessageLength length;
+      std::memcpy(&length, span.data() + offset_, sizeof(length));
+      const size_t payloadOffset = offset_ + BIP_MESSAGE_HEADER_SIZE;
+      // Frames never cross the end of a segment. A length that runs past it
+      // can only come from a corrupted buffer, so skip the rest of the segment
+      if (length <= span.size() - payloadOffset) {
+        message_ = span.substr(payloadOffset, length);
+        return;
+      }
+    }
+    ++span_;
+    offset_ = 0;
+  }
+  message_ = {};
+}
+
+} // namespace mvi
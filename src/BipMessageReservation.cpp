@@ -0,0 +1,52 @@
+#include "BipMessageReservation.hpp"
+
+#include "BipMessageFrame.hpp"
+
+#include <cstring> // for memcpy
+#include <utility>
+
+namespace mvi {
+
+BipMessageReservation::BipMessageReservation(BipBufferWriterReservation&& reservation)
+  : reservation_(std::move(reservation)) {}
+
+BipMessageReservation::~BipMessageReservation() {
+  commit();
+}
+
+BipMessageReservation& BipMessageReservation::operator=(BipMessageReservation&& other) noexcept {
+  if (this != &other) {
+    commit(); // Commit the current message, with its header, if one is held
+    reservation_ = std::move(other.reservation_);
+  }
+  return *this;
+}
+
+uint8_t* BipMessageReservation::data() {
+  return reservation_.data() + BIP_MESSAGE_HEADER_SIZE;
+}
+
+size_t BipMessageReservation::size() const {
+  const size_t size = reservation_.size();
+  return size > BIP_MESSAGE_HEADER_SIZE ? size - BIP_MESSAGE_HEADER_SIZE : 0;
+}
+
+bool BipMessageReservation::truncate(size_t newSize) {
+  if (!reservation_ || newSize > size()) { return false; }
+  return reservation_.truncate(newSize + BIP_MESSAGE_HEADER_SIZE);
+}
+
+void BipMessageReservation::cancel() {
+  reservation_.cancel();
+}
+
+void BipMessageReservation::commit() {
+  // A canceled reservation has a size of zero and writes no frame at all
+  if (reservation_.size() >= BIP_MESSAGE_HEADER_SIZE) {
+    const auto length = BipMessageLength(reservation_.size() - BIP_MESSAGE_HEADER_SIZE);
+    std::memcpy(reservation_.data(), &length, sizeof(length));
+  }
+  reservation_.commit();
+}
+
+} // namespace mvi
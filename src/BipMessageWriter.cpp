@@ -0,0 +1,26 @@
+#include "BipMessageWriter.hpp"
+
+#include "BipMessageFrame.hpp"
+
+#include <cstring> // for memcpy
+#include <limits>
+#include <utility>
+
+namespace mvi {
+
+BipMessageReservation BipMessageWriter::reserve(size_t maxLength) {
+  if (maxLength > std::numeric_limits<BipMessageLength>::max()) { return {}; }
+  auto reservation = writer_.reserve(maxLength + BIP_MESSAGE_HEADER_SIZE);
+  if (!reservation) { return {}; }
+  return BipMessageReservation{std::move(reservation)};
+}
+
+bool BipMessageWriter::write(const void* data, size_t length) {
+  auto reservation = reserve(length);
+  if (!reservation) { return false; }
+  if (length > 0) { std::memcpy(reservation.data(), data, length); }
+  reservation.commit();
+  return true;
+}
+
+} // namespace mvi
@@ -1,5 +1,12 @@
 #include "SharedMemory.hpp"
 
+#include "UnixSocket.hpp"
+
+#include <algorithm> // for max, min
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -9,9 +16,9 @@
 #include <errno.h> // errno
 #include <fcntl.h> // for O_* constants
 #include <limits.h> // IWYU pragma: keep, NAME_MAX
-#include <sys/mman.h> // ::mmap(), ::munmap()
+#include <sys/mman.h> // ::mmap(), ::munmap(), ::msync()
 #include <sys/stat.h> // for mode constants
-#include <unistd.h> // ::close()
+#include <unistd.h> // ::close(), ::sysconf()
 #endif // _WIN32
 
 #ifndef NAME_MAX
@@ -36,6 +43,8 @@ SharedMemory::SharedMemory(SharedMemory&& other) noexcept
     data_(other.data_),
     size_(other.size_),
     capacity_(other.capacity_),
+    mappedSize_(other.mappedSize_),
+    backing_(other.backing_),
     handle_(other.handle_) {
   other.data_ = nullptr;
   other.handle_ = nullptr;
@@ -47,7 +56,12 @@ SharedMemory::SharedMemory(SharedMemory&& other) noexcept
     data_(other.data_),
     size_(other.size_),
     capacity_(other.capacity_),
-    fd_(other.fd_) {
+    mappedSize_(other.mappedSize_),
+    backing_(other.backing_),
+    fd_(other.fd_),
+    reservedSize_(other.reservedSize_),
+    access_(other.access_),
+    options_(other.options_) {
   other.data_ = nullptr;
   other.fd_ = -1;
 }
@@ -61,11 +75,16 @@ SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
     data_ = other.data_;
     size_ = other.size_;
     capacity_ = other.capacity_;
+    mappedSize_ = other.mappedSize_;
+    backing_ = other.backing_;
 #ifdef _WIN32
     handle_ = other.handle_;
     other.handle_ = nullptr;
 #else
     fd_ = other.fd_;
+    reservedSize_ = other.reservedSize_;
+    access_ = other.access_;
+    options_ = other.options_;
     other.fd_ = -1;
 #endif
   }
@@ -84,10 +103,75 @@ size_t SharedMemory::capacity() const {
   return capacity_;
 }
 
+SharedMemory SharedMemory::Anonymous(size_t size) {
+  SharedMemory shm(std::string{}, size);
+  shm.normalizedName_.clear();
+  shm.backing_ = Backing::Anonymous;
+  return shm;
+}
+
+SharedMemory SharedMemory::File(const std::string& path, size_t size) {
+  SharedMemory shm(path, size);
+  shm.normalizedName_ = path;
+  shm.backing_ = Backing::File;
+  return shm;
+}
+
+std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access) {
+  return open(access, Options{});
+}
+
+std::optional<std::system_error> SharedMemory::adopt(int fd, SharedMemory::Access access) {
+  return adopt(fd, access, Options{});
+}
+
+std::optional<std::system_error> SharedMemory::send(int socket) const {
+  if (fd() < 0) {
+    return std::system_error(std::make_error_code(std::errc::bad_file_descriptor), "not open");
+  }
+  return SendFileDescriptor(socket, fd());
+}
+
+std::optional<std::system_error> SharedMemory::receive(int socket, SharedMemory::Access access) {
+  return receive(socket, access, Options{});
+}
+
+std::optional<std::system_error> SharedMemory::receive(
+  int socket, SharedMemory::Access access, const SharedMemory::Options& options) {
+  int fd = -1;
+  if (auto err = ReceiveFileDescriptor(socket, fd)) { return err; }
+  return adopt(fd, access, options);
+}
+
+static size_t RoundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Reads one byte of every page so the pages are faulted in. Reading avoids
+// racing with other processes that are already writing to the area
+static void TouchPages(const void* data, size_t size) {
+  const size_t pageSize = SharedMemory::PageSize();
+  const auto* bytes = static_cast<const volatile uint8_t*>(data);
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    (void)bytes[offset];
+  }
+}
+
 #ifdef _WIN32
 // Windows shared memory implementation
 
-std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access) {
+std::optional<std::system_error> SharedMemory::open(
+  SharedMemory::Access access, const SharedMemory::Options& options) {
+  if (backing_ != Backing::Named) {
+    return std::system_error(
+      ERROR_NOT_SUPPORTED, std::system_category(), "only named areas are supported");
+  }
+  if (options.mirror) {
+    // Placeholder mappings (VirtualAlloc2 / MapViewOfFile3) would be needed to place two views
+    // back to back, which are not available on all supported Windows versions
+    return std::system_error(
+      ERROR_NOT_SUPPORTED, std::system_category(), "mirrored mappings are not supported");
+  }
   if (name_.empty() || name_.size() > NAME_MAX) {
     return std::system_error(ERROR_INVALID_PARAMETER,
       std::system_category(),
@@ -101,19 +185,23 @@ std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access)
     }
   }
 
-  if (access == Access::ReadWrite) {
+  if (access == Access::ReadWrite && size_ > 0) {
+    // Large pages would require SEC_LARGE_PAGES and the SeLockMemoryPrivilege,
+    // so options.hugePages falls back to regular pages
+    const size_t capacity = RoundUp(size_, PageSize());
     handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE, // Use the paging file
       nullptr, // Default security
       PAGE_READWRITE, // Read/write access
-      0, // High-order DWORD(size_)
-      DWORD(size_), // Low-order DWORD(size_)
+      DWORD(uint64_t(capacity) >> 32), // High-order DWORD(capacity)
+      DWORD(capacity), // Low-order DWORD(capacity)
       name_.c_str()); // Name of mapping object
     if (!handle_) {
       const DWORD err = GetLastError();
       return std::system_error(int(err), std::system_category(), "CreateFileMappingA");
     }
   } else {
-    handle_ = OpenFileMappingA(FILE_MAP_READ, // Read access
+    // Without a size an existing mapping is opened, also for ReadWrite access
+    handle_ = OpenFileMappingA(access == Access::ReadWrite ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ,
       FALSE, // Do not inherit the name
       name_.c_str()); // Name of mapping object
     if (!handle_) {
@@ -122,16 +210,36 @@ std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access)
     }
   }
 
-  capacity_ = size_;
-
+  // Map the whole section, its page-rounded size is the capacity
   const DWORD accessFlags = access == Access::ReadWrite ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ;
-  data_ = MapViewOfFile(handle_, accessFlags, 0, 0, size_);
+  data_ = MapViewOfFile(handle_, accessFlags, 0, 0, 0);
 
   if (!data_) {
     const DWORD err = GetLastError();
     close();
     return std::system_error(int(err), std::system_category(), "MapViewOfFile");
   }
+
+  MEMORY_BASIC_INFORMATION info = {};
+  if (VirtualQuery(data_, &info, sizeof(info)) == 0) {
+    const DWORD err = GetLastError();
+    close();
+    return std::system_error(int(err), std::system_category(), "VirtualQuery");
+  }
+  capacity_ = size_t(info.RegionSize);
+  mappedSize_ = capacity_;
+  if (size_ == 0) { size_ = capacity_; }
+  if (capacity_ < size_) {
+    close();
+    return std::system_error(ERROR_INVALID_PARAMETER, std::system_category(), "size mismatch");
+  }
+
+  if (options.prefault) { TouchPages(data_, mappedSize_); }
+  if (options.lock && !VirtualLock(data_, mappedSize_)) {
+    const DWORD err = GetLastError();
+    close();
+    return std::system_error(int(err), std::system_category(), "VirtualLock");
+  }
   return {};
 }
 
@@ -180,28 +288,186 @@ std::optional<std::system_error> SharedMemory::Destroy(const std::string& name)
   return {};
 }
 
+size_t SharedMemory::PageSize() {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return size_t(info.dwAllocationGranularity);
+}
+
+size_t SharedMemory::HugePageSize() {
+  const size_t largePageSize = GetLargePageMinimum();
+  return largePageSize > 0 ? largePageSize : PageSize();
+}
+
+std::optional<std::system_error> SharedMemory::adopt(int, Access, const Options&) {
+  return std::system_error(
+    ERROR_NOT_SUPPORTED, std::system_category(), "descriptor passing is not supported");
+}
+
+int SharedMemory::fd() const {
+  return -1;
+}
+
+std::optional<std::system_error> SharedMemory::resize(size_t) {
+  return std::system_error(
+    ERROR_NOT_SUPPORTED, std::system_category(), "resizing is not supported");
+}
+
+std::optional<std::system_error> SharedMemory::sync() const {
+  if (data_ && !FlushViewOfFile(data_, mappedSize_)) {
+    const DWORD err = GetLastError();
+    return std::system_error(int(err), std::system_category(), "FlushViewOfFile");
+  }
+  return {};
+}
+
 #else
 // POSIX shared memory implementation
 
-std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access) {
-  if (name_.empty() || name_.size() > NAME_MAX) {
+// Maps `size` bytes of `fd`. With a mirror, address space for the area and the
+// mirrored part is reserved first and then replaced by the two mappings, so
+// they are guaranteed to be adjacent. Returns MAP_FAILED and sets errno on
+// error. `reservedSize` is set to the size of the address space to unmap
+static void* MapArea(int fd,
+  size_t size,
+  int protections,
+  const SharedMemory::Options& options,
+  size_t& mappedSize,
+  size_t& reservedSize) {
+  if (!options.mirror) {
+    mappedSize = size;
+    reservedSize = std::max(size, RoundUp(options.reserve, SharedMemory::PageSize()));
+    if (!options.hugePages && reservedSize == size) {
+      return ::mmap(nullptr, size, protections, MAP_SHARED, fd, 0);
+    }
+
+    // Reserve the address space to grow into, aligned to the huge page size
+    // when huge pages should back it, and map the area at its start
+    const size_t alignment =
+      options.hugePages ? SharedMemory::HugePageSize() : SharedMemory::PageSize();
+    const size_t window = reservedSize + alignment;
+    void* base = ::mmap(nullptr, window, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) { return MAP_FAILED; }
+    auto* begin = static_cast<uint8_t*>(base);
+    auto* aligned =
+      reinterpret_cast<uint8_t*>(RoundUp(reinterpret_cast<uintptr_t>(begin), alignment));
+    if (aligned > begin) { ::munmap(begin, size_t(aligned - begin)); }
+    const size_t tail = window - size_t(aligned - begin) - reservedSize;
+    if (tail > 0) { ::munmap(aligned + reservedSize, tail); }
+
+    if (::mmap(aligned, size, protections, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      const int err = errno;
+      ::munmap(aligned, reservedSize);
+      errno = err;
+      return MAP_FAILED;
+    }
+    return aligned;
+  }
+
+  const size_t mirrorSize = size - options.mirrorOffset;
+  mappedSize = size + mirrorSize;
+  reservedSize = mappedSize;
+  void* base = ::mmap(nullptr, mappedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) { return MAP_FAILED; }
+
+  uint8_t* mirror = static_cast<uint8_t*>(base) + size;
+  if (::mmap(base, size, protections, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+      ::mmap(mirror,
+        mirrorSize,
+        protections,
+        MAP_SHARED | MAP_FIXED,
+        fd,
+        off_t(options.mirrorOffset)) == MAP_FAILED) {
+    const int err = errno;
+    ::munmap(base, mappedSize);
+    errno = err;
+    return MAP_FAILED;
+  }
+  return base;
+}
+
+// Checks that a mirrored mapping of `size` bytes can be made with `options`
+static std::optional<std::system_error> CheckMirror(
+  size_t size, const SharedMemory::Options& options) {
+  if (!options.mirror) { return {}; }
+  const size_t pageSize = SharedMemory::PageSize();
+  if (size % pageSize != 0 || options.mirrorOffset % pageSize != 0 ||
+      options.mirrorOffset >= size) {
     return std::system_error(EINVAL,
       std::system_category(),
-      "name must be between 1 and " + std::to_string(NAME_MAX) + " characters");
+      "mirrored mappings require a size and mirror offset that are multiples of the page size");
   }
-  for (const char c : name_) {
-    if (!std::isalnum(c)) {
-      return std::system_error(
-        EINVAL, std::system_category(), "name must only contain alpha-numeric characters");
+  return {};
+}
+
+// Creates the file descriptor of an anonymous area. Linux uses a sealable
+// memfd, other systems a POSIX shared memory object that is unlinked right
+// away. Returns -1 and sets errno on error
+static int CreateAnonymous() {
+#ifdef __linux__
+  return ::memfd_create("bipbuffer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+  static std::atomic<unsigned> counter{0};
+  for (;;) {
+    const std::string name = "/mvi" + std::to_string(::getpid()) + "x" +
+                             std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    const int fd = ::shm_open(name.c_str(), // NOLINT(cppcoreguidelines-pro-type-vararg)
+      O_CREAT | O_EXCL | O_RDWR,
+      S_IWUSR | S_IRUSR);
+    if (fd >= 0) {
+      ::shm_unlink(name.c_str());
+      return fd;
     }
+    if (errno != EEXIST) { return -1; }
   }
+#endif
+}
 
-  const std::string normalizedName = "/" + name_;
-  const int flags = access == Access::ReadWrite ? (O_CREAT | O_RDWR) : O_RDONLY;
-  fd_ = ::shm_open(normalizedName.c_str(), // NOLINT(cppcoreguidelines-pro-type-vararg)
-    flags,
-    S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
-  if (fd_ < 0) { return std::system_error(errno, std::system_category(), "shm_open"); }
+std::optional<std::system_error> SharedMemory::open(
+  SharedMemory::Access access, const SharedMemory::Options& options) {
+  if (auto err = CheckMirror(size_, options)) { return err; }
+  // Without a size there is nothing to create, only an existing area to open
+  const int createFlag = size_ > 0 ? O_CREAT : 0;
+  if (backing_ == Backing::Anonymous) {
+    if (size_ == 0) {
+      return std::system_error(EINVAL,
+        std::system_category(),
+        "anonymous areas need a size, peers attach with receive()");
+    }
+    if (access != Access::ReadWrite) {
+      return std::system_error(EINVAL,
+        std::system_category(),
+        "anonymous areas are created with ReadWrite access, peers attach with receive()");
+    }
+    this->close();
+    fd_ = CreateAnonymous();
+    if (fd_ < 0) { return std::system_error(errno, std::system_category(), "memfd_create"); }
+  } else if (backing_ == Backing::File) {
+    const int flags = access == Access::ReadWrite ? (createFlag | O_RDWR) : O_RDONLY;
+    fd_ = ::open(name_.c_str(), // NOLINT(cppcoreguidelines-pro-type-vararg)
+      flags | O_CLOEXEC,
+      S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+    if (fd_ < 0) { return std::system_error(errno, std::system_category(), "open"); }
+  } else {
+    if (name_.empty() || name_.size() > NAME_MAX) {
+      return std::system_error(EINVAL,
+        std::system_category(),
+        "name must be between 1 and " + std::to_string(NAME_MAX) + " characters");
+    }
+    for (const char c : name_) {
+      if (!std::isalnum(c)) {
+        return std::system_error(
+          EINVAL, std::system_category(), "name must only contain alpha-numeric characters");
+      }
+    }
+
+    const std::string normalizedName = "/" + name_;
+    const int flags = access == Access::ReadWrite ? (createFlag | O_RDWR) : O_RDONLY;
+    fd_ = ::shm_open(normalizedName.c_str(), // NOLINT(cppcoreguidelines-pro-type-vararg)
+      flags,
+      S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+    if (fd_ < 0) { return std::system_error(errno, std::system_category(), "shm_open"); }
+  }
 
   struct stat shm_stat = {};
   if (::fstat(fd_, &shm_stat) == -1 || shm_stat.st_size < 0) {
@@ -212,6 +478,17 @@ std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access)
 
   capacity_ = size_t(shm_stat.st_size);
 
+  // Take the size of an existing area. Its creator may not have set the size
+  // yet, which is reported as EAGAIN so that the caller can retry
+  if (size_ == 0) {
+    if (capacity_ == 0) {
+      ::close(fd_);
+      fd_ = -1;
+      return std::system_error(EAGAIN, std::system_category(), "size not set by the creator yet");
+    }
+    size_ = capacity_;
+  }
+
   // Ensure the shared memory area size is at least as large as requested
   if (capacity_ < size_) {
     if (access == Access::ReadWrite) {
@@ -222,8 +499,11 @@ std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access)
         return std::system_error(EOVERFLOW, std::system_category(), "not enough capacity");
       }
 
-      // This is the only way to specify the size of a POSIX shared memory object
-      if (::ftruncate(fd_, off_t(size_)) == -1) {
+      // This is the only way to specify the size of a POSIX shared memory
+      // object. The size is rounded up to whole pages, which are mapped anyway
+      const bool hugePages = options.hugePages && !options.mirror;
+      const size_t capacity = RoundUp(size_, hugePages ? HugePageSize() : PageSize());
+      if (::ftruncate(fd_, off_t(capacity)) == -1) {
         ::close(fd_);
         fd_ = -1;
         return std::system_error(errno, std::system_category(), "ftruncate");
@@ -250,31 +530,160 @@ std::optional<std::system_error> SharedMemory::open(SharedMemory::Access access)
     }
   }
 
+#ifdef F_SEAL_SHRINK
+  // Peers that received the memfd can not shrink it under a mapping, which
+  // would make accesses beyond the new end raise SIGBUS
+  if (backing_ == Backing::Anonymous && ::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK) == -1) {
+    const int err = errno;
+    ::close(fd_);
+    fd_ = -1;
+    return std::system_error(err, std::system_category(), "fcntl(F_ADD_SEALS)");
+  }
+#endif
+
+  return map(access, options);
+}
+
+std::optional<std::system_error> SharedMemory::adopt(
+  int fd, SharedMemory::Access access, const SharedMemory::Options& options) {
+  this->close();
+  if (fd < 0) { return std::system_error(EBADF, std::system_category(), "invalid descriptor"); }
+  fd_ = fd;
+
+  struct stat shm_stat = {};
+  if (::fstat(fd_, &shm_stat) == -1 || shm_stat.st_size < 0) {
+    const int err = errno;
+    this->close();
+    return std::system_error(err, std::system_category(), "fstat");
+  }
+  capacity_ = size_t(shm_stat.st_size);
+  if (size_ == 0) { size_ = capacity_; }
+  if (capacity_ < size_ || capacity_ == 0) {
+    this->close();
+    return std::system_error(EEXIST, std::system_category(), "size mismatch");
+  }
+  if (auto err = CheckMirror(size_, options)) {
+    this->close();
+    return err;
+  }
+  return map(access, options);
+}
+
+int SharedMemory::fd() const {
+  return fd_;
+}
+
+std::optional<std::system_error> SharedMemory::sync() const {
+  if (data_ && ::msync(data_, mappedSize_, MS_SYNC) != 0) {
+    return std::system_error(errno, std::system_category(), "msync");
+  }
+  return {};
+}
+
+// Applies the advice of `options` to a mapping
+static std::optional<std::system_error> AdviseArea(
+  void* data, size_t size, SharedMemory::Access access, const SharedMemory::Options& options) {
+#ifdef MADV_HUGEPAGE
+  // Advisory only: without transparent huge page support for shared memory
+  // the area silently keeps using regular pages
+  if (options.hugePages) { ::madvise(data, size, MADV_HUGEPAGE); }
+#endif
+  if (options.prefault) {
+#ifdef MADV_POPULATE_WRITE
+    // Populating for writing also avoids the write faults of a writable
+    // mapping, without modifying the contents. Older kernels touch the pages
+    const bool writable = access == SharedMemory::Access::ReadWrite;
+    const int advice = writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ;
+    if (::madvise(data, size, advice) != 0) { TouchPages(data, size); }
+#else
+    (void)access;
+    TouchPages(data, size);
+#endif
+  }
+  if (options.lock && ::mlock(data, size) != 0) {
+    return std::system_error(errno, std::system_category(), "mlock");
+  }
+  return {};
+}
+
+std::optional<std::system_error> SharedMemory::map(
+  SharedMemory::Access access, const SharedMemory::Options& options) {
   const int protections = access == Access::ReadWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
-  data_ = ::mmap(nullptr, // addr
-    size_, // length
-    protections, // prot
-    MAP_SHARED, // flags
-    fd_, // fd
-    0 // offset
-  );
-  if (data_ == MAP_FAILED) { return std::system_error(errno, std::system_category(), "mmap"); }
+  // A mirror must start right after `size_`, otherwise the whole capacity is mapped
+  const size_t mapSize = options.mirror ? size_ : capacity_;
+  data_ = MapArea(fd_, mapSize, protections, options, mappedSize_, reservedSize_);
+  if (data_ == MAP_FAILED) {
+    const int err = errno;
+    data_ = nullptr;
+    this->close();
+    return std::system_error(err, std::system_category(), "mmap");
+  }
 
   if (!data_) {
     const int err = errno ? errno : EINVAL;
     this->close();
     return std::system_error(err, std::system_category(), "mmap");
   }
+  access_ = access;
+  options_ = options;
+
+  if (auto err = AdviseArea(data_, mappedSize_, access, options)) {
+    this->close();
+    return err;
+  }
   return {};
 }
 
+std::optional<std::system_error> SharedMemory::resize(size_t size) {
+  if (!data_) { return std::system_error(EBADF, std::system_category(), "not open"); }
+  if (options_.mirror) {
+    return std::system_error(EINVAL, std::system_category(), "mirrored areas can not be resized");
+  }
+  if (size <= mappedSize_) {
+    size_ = std::max(size_, size);
+    return {};
+  }
+  if (size > reservedSize_) {
+    return std::system_error(ENOMEM, std::system_category(), "not enough reserved address space");
+  }
+
+  struct stat shm_stat = {};
+  if (::fstat(fd_, &shm_stat) == -1 || shm_stat.st_size < 0) {
+    return std::system_error(errno, std::system_category(), "fstat");
+  }
+  size_t capacity = size_t(shm_stat.st_size);
+  if (capacity < size) {
+    if (access_ != Access::ReadWrite) {
+      return std::system_error(EAGAIN, std::system_category(), "not grown by the owner yet");
+    }
+    const size_t granularity = options_.hugePages ? HugePageSize() : PageSize();
+    capacity = std::min(RoundUp(size, granularity), reservedSize_);
+    if (::ftruncate(fd_, off_t(capacity)) == -1) {
+      return std::system_error(errno, std::system_category(), "ftruncate");
+    }
+  }
+  // The object may have been grown further than this mapping can follow
+  capacity = std::min(capacity, reservedSize_);
+
+  // Replacing the mapping in place keeps its address, and the contents are the
+  // same pages of the same object, so concurrent accesses are not disturbed
+  const int protections = access_ == Access::ReadWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+  if (::mmap(data_, capacity, protections, MAP_SHARED | MAP_FIXED, fd_, 0) == MAP_FAILED) {
+    return std::system_error(errno, std::system_category(), "mmap");
+  }
+  capacity_ = capacity;
+  mappedSize_ = capacity;
+  size_ = size;
+  return AdviseArea(data_, mappedSize_, access_, options_);
+}
+
 std::optional<std::system_error> SharedMemory::close() {
   void* data = data_;
   const int fd = fd_;
   data_ = nullptr;
   fd_ = -1;
 
-  if (data && 0 != ::munmap(data, size_)) {
+  if (data && 0 != ::munmap(data, reservedSize_)) {
     if (fd) { ::close(fd); }
     return std::system_error(errno, std::system_category(), "munmap");
   }
@@ -296,6 +705,24 @@ std::optional<std::system_error> SharedMemory::Destroy(const std::string& name)
   return {};
 }
 
+size_t SharedMemory::PageSize() {
+  return size_t(::sysconf(_SC_PAGESIZE));
+}
+
+size_t SharedMemory::HugePageSize() {
+#ifdef __linux__
+  static const size_t hugePageSize = [] {
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    size_t size = 0;
+    if (file >> size && size > PageSize()) { return size; }
+    return PageSize();
+  }();
+  return hugePageSize;
+#else
+  return PageSize();
+#endif
+}
+
 #endif // _WIN32
 
 } // namespace mvi
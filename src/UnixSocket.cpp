@@ -0,0 +1,85 @@
+#include "UnixSocket.hpp"
+
+#ifndef _WIN32
+#include <errno.h> // errno
+#include <sys/socket.h> // ::sendmsg(), ::recvmsg()
+#include <sys/uio.h> // iovec
+
+#include <cstring> // for memcpy
+#endif // _WIN32
+
+namespace mvi {
+
+#ifdef _WIN32
+
+std::optional<std::system_error> SendFileDescriptor(int, int) {
+  return std::system_error(
+    std::make_error_code(std::errc::function_not_supported), "descriptor passing");
+}
+
+std::optional<std::system_error> ReceiveFileDescriptor(int, int&) {
+  return std::system_error(
+    std::make_error_code(std::errc::function_not_supported), "descriptor passing");
+}
+
+#else
+
+std::optional<std::system_error> SendFileDescriptor(int socket, int fd) {
+  // A descriptor is sent as SCM_RIGHTS ancillary data, which must accompany at
+  // least one byte of regular data
+  char byte = 0;
+  iovec iov{&byte, sizeof(byte)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  ssize_t sent;
+  do {
+    sent = ::sendmsg(socket, &msg, 0);
+  } while (sent == -1 && errno == EINTR);
+  if (sent == -1) { return std::system_error(errno, std::system_category(), "sendmsg"); }
+  return {};
+}
+
+std::optional<std::system_error> ReceiveFileDescriptor(int socket, int& fd) {
+  char byte = 0;
+  iovec iov{&byte, sizeof(byte)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t received;
+  do {
+    received = ::recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+  } while (received == -1 && errno == EINTR);
+  if (received == -1) { return std::system_error(errno, std::system_category(), "recvmsg"); }
+  if (received == 0) {
+    return std::system_error(ECONNRESET, std::system_category(), "socket closed by peer");
+  }
+
+  const cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+    return std::system_error(EBADMSG, std::system_category(), "no file descriptor received");
+  }
+  std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  return {};
+}
+
+#endif // _WIN32
+
+} // namespace mvi
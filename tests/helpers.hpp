@@ -0,0 +1,14 @@
+#pragma once
+
+#include "BipBufferWriter.hpp"
+
+#include <cstring> // for memcpy
+#include <string_view>
+
+// Writes `data` as one message, returns false if there is not enough space
+inline bool Write(mvi::BipBufferWriter& writer, std::string_view data) {
+  auto reservation = writer.reserve(data.size());
+  if (!reservation) { return false; }
+  std::memcpy(reservation.data(), data.data(), data.size());
+  return true;
+}
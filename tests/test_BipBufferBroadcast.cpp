@@ -0,0 +1,171 @@
+#include "BipBufferBroadcastHeader.hpp"
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "helpers.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memcpy
+#include <thread>
+#include <vector>
+
+constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
+
+TEST_CASE("BipBufferBroadcastHeader reader registration", "[bipbuffer][broadcast]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferBroadcastHeader) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  REQUIRE(mvi::BipBufferBroadcastHeader::Attach(buffer.data(), buffer.size()) == nullptr);
+  auto layout = mvi::BipBufferBroadcastHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+  REQUIRE(layout->bufferSize == 32);
+  REQUIRE(mvi::BipBufferBroadcastHeader::Attach(buffer.data(), buffer.size()) == layout);
+
+  // Every slot can be claimed once
+  constexpr size_t MAX_READERS = mvi::BipBufferBroadcastHeader::MAX_READERS;
+  for (size_t slot = 0; slot < MAX_READERS; ++slot) {
+    REQUIRE(layout->registerReader() == slot);
+  }
+  REQUIRE(!layout->registerReader());
+  REQUIRE(layout->joinRequests.load(ORDER_STRICT) == MAX_READERS);
+
+  // Unregistering a joining reader withdraws its join request
+  layout->unregisterReader(3);
+  REQUIRE(layout->joinRequests.load(ORDER_STRICT) == MAX_READERS - 1);
+  REQUIRE(layout->readers[3].read.load(ORDER_STRICT) == mvi::BipBufferBroadcastHeader::FREE);
+  REQUIRE(layout->registerReader() == 3);
+
+  // The writer admits all joining readers at the write position when it publishes
+  mvi::BipBufferWriter writer{*layout};
+  REQUIRE(Write(writer, "abc"));
+  REQUIRE(layout->joinRequests.load(ORDER_STRICT) == 0);
+  for (const auto& cursor : layout->readers) {
+    REQUIRE(cursor.read.load(ORDER_STRICT) == 0);
+  }
+}
+
+TEST_CASE("BipBufferBroadcast basic lifecycle", "[bipbuffer][broadcast]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferBroadcastHeader) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferBroadcastHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  const auto slotA = layout->registerReader();
+  REQUIRE(slotA);
+  mvi::BipBufferReader readerA{*layout, *slotA};
+  mvi::BipBufferWriter writer{*layout};
+
+  // No data until the writer admits the reader
+  REQUIRE(readerA.read().empty());
+  REQUIRE(readerA.readAll()[0].empty());
+  REQUIRE(!readerA.advance(1));
+
+  REQUIRE(Write(writer, "abc"));
+  REQUIRE(readerA.read() == "abc");
+
+  // A reader registered later only sees data written after it joined
+  const auto slotB = layout->registerReader();
+  REQUIRE(slotB);
+  mvi::BipBufferReader readerB{*layout, *slotB};
+  REQUIRE(readerB.read().empty());
+  REQUIRE(Write(writer, "def"));
+  REQUIRE(readerA.read() == "abcdef");
+  REQUIRE(readerB.read() == "def");
+  REQUIRE(readerB.advance(3));
+  REQUIRE(layout->readers[*slotA].read.load(ORDER_STRICT) == 0);
+  REQUIRE(layout->readers[*slotB].read.load(ORDER_STRICT) == 6);
+
+  // Fill the buffer; free space is bounded by the slowest reader
+  REQUIRE(Write(writer, "01234567890123456789012345"));
+  REQUIRE(!writer.reserve(1));
+  REQUIRE(readerB.read().size() == 26);
+  REQUIRE(readerB.advance(26));
+  REQUIRE(!writer.reserve(1));
+  REQUIRE(readerA.read().size() == 32);
+  REQUIRE(readerA.advance(32));
+
+  // The writer wraps around once both readers have caught up
+  REQUIRE(Write(writer, "x"));
+  REQUIRE(layout->write.load(ORDER_STRICT) == 1);
+  REQUIRE(layout->last.load(ORDER_STRICT) == 32);
+  REQUIRE(readerB.read() == "x");
+  REQUIRE(readerB.advance(1));
+
+  // Reader A has not consumed the wrapped data and holds back the writer,
+  // until it unregisters
+  REQUIRE(!writer.reserve(31));
+  layout->unregisterReader(*slotA);
+  REQUIRE(writer.reserve(31));
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBufferBroadcast concurrent readers", "[bipbuffer][broadcast][concurrent]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferBroadcastHeader) + 1024;
+  constexpr size_t READER_COUNT = 3;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferBroadcastHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  std::vector<uint8_t> testData(1024 * 1024); // 1MB of test data for writing
+  for (size_t i = 0; i < testData.size(); ++i) {
+    testData[i] = static_cast<uint8_t>(i % 251); // Fill with some pattern
+  }
+
+  // Readers registered before the first write receive all data
+  std::vector<mvi::BipBufferReader> readers;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    const auto slot = layout->registerReader();
+    REQUIRE(slot);
+    readers.emplace_back(*layout, *slot);
+  }
+  mvi::BipBufferWriter writer{*layout};
+
+  auto writerFunc = [&]() {
+    for (size_t offset = 0; offset < testData.size(); offset += 64) {
+      auto reservation = writer.reserve(64);
+      while (!reservation) {
+        std::this_thread::yield();
+        reservation = writer.reserve(64);
+      }
+      std::memcpy(reservation.data(), testData.data() + offset, 64);
+    }
+  };
+
+  std::array<size_t, READER_COUNT> errors{};
+  auto readerFunc = [&](size_t index) {
+    mvi::BipBufferReader& reader = readers[index];
+    size_t totalRead = 0;
+    while (totalRead < testData.size()) {
+      const auto data = reader.read();
+      if (data.empty()) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (data.size() > testData.size() - totalRead ||
+          std::memcmp(data.data(), testData.data() + totalRead, data.size()) != 0) {
+        ++errors[index];
+        break;
+      }
+      totalRead += data.size();
+      if (!reader.advance(data.size())) { ++errors[index]; }
+    }
+  };
+
+  std::thread writerThread(writerFunc);
+  std::vector<std::thread> readerThreads;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    readerThreads.emplace_back(readerFunc, i);
+  }
+  writerThread.join();
+  for (auto& thread : readerThreads) {
+    thread.join();
+  }
+
+  REQUIRE(errors == std::array<size_t, READER_COUNT>{});
+}
@@ -0,0 +1,91 @@
+#include "BipBufferCoroutine.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memcpy
+#include <memory>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+static mvi::BipTask Produce(mvi::BipBufferAsyncWriter writer, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    auto reservation = co_await writer.reserve(sizeof(i));
+    std::memcpy(reservation.data(), &i, sizeof(i));
+  }
+}
+
+static mvi::BipTask Consume(mvi::BipBufferAsyncReader reader, size_t count, size_t& errors) {
+  size_t expected = 0;
+  while (expected < count) {
+    const std::string_view data = co_await reader.next();
+    for (size_t j = 0; j + sizeof(size_t) <= data.size(); j += sizeof(size_t)) {
+      size_t value;
+      std::memcpy(&value, data.data() + j, sizeof(value));
+      if (value != expected++) { ++errors; }
+    }
+    if (data.size() % sizeof(size_t) != 0 || !reader.advance(data.size())) { ++errors; }
+  }
+}
+
+TEST_CASE("BipBuffer coroutines suspend until ready", "[bipbuffer][coroutine]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+  mvi::BipBufferScheduler scheduler;
+
+  std::string_view received;
+  auto consume = [](mvi::BipBufferAsyncReader asyncReader, std::string_view& out) -> mvi::BipTask {
+    out = co_await asyncReader.next();
+  };
+  scheduler.spawn(consume({scheduler, reader}, received));
+  REQUIRE(scheduler.size() == 1);
+
+  // The consumer runs until it suspends on the empty buffer
+  REQUIRE(scheduler.poll() == 1);
+  REQUIRE(scheduler.poll() == 0);
+  REQUIRE(received.empty());
+
+  // Once data is available the consumer is queued and resumed on the next poll
+  auto reservation = writer.reserve(3);
+  std::memcpy(reservation.data(), "abc", 3);
+  reservation.commit();
+  REQUIRE(scheduler.poll() == 0);
+  REQUIRE(scheduler.poll() == 1);
+  REQUIRE(received == "abc");
+  REQUIRE(scheduler.size() == 0);
+}
+
+TEST_CASE("BipBuffer coroutines multiplex many streams", "[bipbuffer][coroutine]") {
+  constexpr size_t STREAM_COUNT = 200;
+  constexpr size_t MESSAGE_COUNT = 500;
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+
+  struct Stream {
+    alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+    mvi::BipBufferHeaderV2* layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+    mvi::BipBufferWriter writer{*layout};
+    mvi::BipBufferReader reader{*layout};
+  };
+
+  // All producers and consumers share a single thread
+  mvi::BipBufferScheduler scheduler;
+  std::vector<std::unique_ptr<Stream>> streams;
+  size_t errors = 0;
+  for (size_t i = 0; i < STREAM_COUNT; ++i) {
+    streams.push_back(std::make_unique<Stream>());
+    Stream& stream = *streams.back();
+    scheduler.spawn(Consume({scheduler, stream.reader}, MESSAGE_COUNT, errors));
+    scheduler.spawn(Produce({scheduler, stream.writer}, MESSAGE_COUNT));
+  }
+  scheduler.run();
+
+  REQUIRE(scheduler.size() == 0);
+  REQUIRE(errors == 0);
+}
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,97 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "SharedMemory.hpp"
+#include "helpers.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <filesystem>
+#include <string>
+
+TEST_CASE("BipBufferHeader Attach", "[bipbuffer][durability]") {
+  constexpr size_t SIZE = sizeof(mvi::BipBufferHeader) + 64;
+  alignas(mvi::BipBufferHeader) std::array<uint8_t, SIZE> buffer{};
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  // Uninitialized memory has a zero buffer size
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data(), SIZE) == nullptr);
+
+  auto layout = mvi::BipBufferHeader::Create(buffer.data(), SIZE);
+  REQUIRE(layout != nullptr);
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data(), SIZE) == layout);
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data(), SIZE - 1) == nullptr);
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data() + 1, SIZE - 1) == nullptr);
+
+  // Positions outside of the buffer are rejected
+  layout->write = 65;
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data(), SIZE) == nullptr);
+  layout->write = 64;
+  REQUIRE(mvi::BipBufferHeader::Attach(buffer.data(), SIZE) == layout);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+#ifndef _WIN32
+TEST_CASE("BipBuffer file-backed journal", "[bipbuffer][durability][shm]") {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bipjournal.bin";
+  constexpr size_t SIZE = sizeof(mvi::BipBufferHeader) + 64;
+  std::filesystem::remove(path);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  {
+    mvi::SharedMemory file = mvi::SharedMemory::File(path.string(), SIZE);
+    REQUIRE_NO_ERROR(file.open(mvi::SharedMemory::Access::ReadWrite));
+    CHECK(file.name() == path.string());
+    auto layout = mvi::BipBufferHeader::Create(file.as<uint8_t>(), SIZE);
+    REQUIRE(layout != nullptr);
+
+    mvi::BipBufferWriter writer{*layout};
+    mvi::BipBufferReader reader{*layout};
+    writer.setDurability(mvi::Durability::Sync);
+    reader.setDurability(mvi::Durability::Sync);
+
+    // Wrap around once so that both flushed segments are exercised
+    REQUIRE(Write(writer, std::string(40, 'x')));
+    REQUIRE(reader.advance(reader.read().size()));
+    REQUIRE(Write(writer, "one"));
+    REQUIRE(Write(writer, "two"));
+    REQUIRE(Write(writer, std::string(30, 'y')));
+    REQUIRE(reader.read() == "onetwo");
+    REQUIRE(reader.advance(3));
+
+    // Batched commits are flushed once per batch
+    writer.setBatchPolicy({2, 0, std::chrono::nanoseconds::zero()});
+    REQUIRE(Write(writer, "three"));
+    REQUIRE(Write(writer, "four"));
+    CHECK(!writer.durabilityError());
+    REQUIRE_NO_ERROR(file.sync());
+  }
+
+  // A restarted process resumes from the persisted positions, the reader
+  // picks up after the last advance()
+  mvi::SharedMemory file = mvi::SharedMemory::File(path.string(), SIZE);
+  REQUIRE_NO_ERROR(file.open(mvi::SharedMemory::Access::ReadWrite));
+  auto layout = mvi::BipBufferHeader::Attach(file.as<uint8_t>(), SIZE);
+  REQUIRE(layout != nullptr);
+  mvi::BipBufferReader reader{*layout};
+  REQUIRE(reader.read() == "two");
+  REQUIRE(reader.advance(3));
+  REQUIRE(reader.read() == std::string(30, 'y') + "threefour");
+
+  // Opening the file read-only works as well, creation requires ReadWrite
+  mvi::SharedMemory readOnly = mvi::SharedMemory::File(path.string(), SIZE);
+  REQUIRE_NO_ERROR(readOnly.open(mvi::SharedMemory::Access::ReadOnly));
+  mvi::SharedMemory missing = mvi::SharedMemory::File((path.string() + "x"), SIZE);
+  REQUIRE(missing.open(mvi::SharedMemory::Access::ReadOnly));
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE_NO_ERROR(readOnly.close());
+  REQUIRE_NO_ERROR(file.close());
+  std::filesystem::remove(path);
+}
+#endif // _WIN32
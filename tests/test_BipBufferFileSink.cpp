@@ -0,0 +1,223 @@
+#include "BipBufferFileSink.hpp"
+#include "BipBufferWriter.hpp"
+#include "SharedMemory.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memcpy, memset
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <cstddef> // for offsetof
+#include <linux/filter.h>
+#include <linux/io_uring.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef _WIN32
+
+static std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Streams `count` messages of varying sizes through a small buffer into a file
+// while the sink keeps several writes in flight, and checks the file contents
+static void StreamToFile(mvi::BipBufferFileSink::Mode mode) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bipsink.bin";
+  std::filesystem::remove(path);
+  const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0644);
+  REQUIRE(fd >= 0);
+
+  constexpr const char* NAME = "testfilesink";
+  const size_t size = mvi::SharedMemory::PageSize();
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+  mvi::SharedMemory shm(NAME, size);
+  REQUIRE_NO_ERROR(shm.open(mvi::SharedMemory::Access::ReadWrite));
+  auto layout = mvi::BipBufferHeaderV2::Create(shm.as<uint8_t>(), size);
+  REQUIRE(layout != nullptr);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferReader reader{*layout};
+  mvi::BipBufferFileSink sink{reader};
+  auto err = sink.open(fd, 3, 4, mode);
+  if (err && mode == mvi::BipBufferFileSink::Mode::IoUring) {
+    WARN("io_uring is not available: " << err->what());
+    ::close(fd);
+    REQUIRE_NO_ERROR(shm.close());
+    REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+    return;
+  }
+  REQUIRE_NO_ERROR(err);
+  CHECK(sink.usingIoUring() == (mode == mvi::BipBufferFileSink::Mode::IoUring));
+  REQUIRE_NO_ERROR(sink.registerBuffer(shm.as<uint8_t>(), shm.capacity()));
+
+  constexpr size_t MESSAGES = 2000;
+  std::thread producer([layout] {
+    mvi::BipBufferWriter writer{*layout};
+    for (size_t i = 0; i < MESSAGES;) {
+      const size_t length = 1 + i % 200;
+      auto reservation = writer.reserve(length);
+      if (!reservation) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::memset(reservation.data(), int('a' + i % 26), length);
+      ++i;
+    }
+  });
+
+  std::string expected;
+  for (size_t i = 0; i < MESSAGES; ++i) {
+    expected.append(1 + i % 200, char('a' + i % 26));
+  }
+  while (sink.offset() < 3 + expected.size()) {
+    err = sink.inFlight() > 0 ? sink.wait() : sink.poll();
+    if (err) { break; }
+    if (sink.inFlight() == 0) { std::this_thread::yield(); }
+  }
+  producer.join();
+  REQUIRE_NO_ERROR(err);
+  REQUIRE_NO_ERROR(sink.drain());
+  CHECK(sink.offset() == 3 + expected.size());
+  CHECK(sink.inFlight() == 0);
+  CHECK(reader.read().empty());
+  REQUIRE_NO_ERROR(sink.close());
+
+  // The first bytes were skipped by the initial offset
+  const std::string contents = ReadFile(path);
+  REQUIRE(contents.size() == 3 + expected.size());
+  CHECK(contents.substr(0, 3) == std::string(3, '\0'));
+  CHECK(contents.substr(3) == expected);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  ::close(fd);
+  std::filesystem::remove(path);
+  REQUIRE_NO_ERROR(shm.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("BipBufferFileSink with io_uring", "[bipbuffer][sink][shm]") {
+  StreamToFile(mvi::BipBufferFileSink::Mode::IoUring);
+}
+
+TEST_CASE("BipBufferFileSink with a worker thread", "[bipbuffer][sink][shm]") {
+  StreamToFile(mvi::BipBufferFileSink::Mode::Thread);
+}
+
+#ifdef __linux__
+// Makes IORING_REGISTER_PROBE fail with EINVAL on the calling thread and the
+// threads it creates, as it does on Linux 5.1 to 5.5 where io_uring exists but
+// IORING_OP_WRITE does not. Returns false if seccomp filters are not permitted
+static bool FilterIoUringProbe() {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  constexpr uint32_t LOW_WORD = 4;
+#else
+  constexpr uint32_t LOW_WORD = 0;
+#endif
+  sock_filter filter[] = {
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_register, 0, 3),
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, args[1]) + LOW_WORD),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IORING_REGISTER_PROBE, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EINVAL),
+    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+  };
+  sock_fprog program{static_cast<unsigned short>(std::size(filter)), filter};
+  return ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0 &&
+         ::prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0;
+}
+
+TEST_CASE("BipBufferFileSink falls back without io_uring writes", "[bipbuffer][sink]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bipfallback.bin";
+  std::filesystem::remove(path);
+  const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0644);
+  REQUIRE(fd >= 0);
+
+  // The filter only applies to the opening thread and the worker it starts
+  mvi::BipBufferFileSink sink{reader};
+  bool filtered = false;
+  std::optional<std::system_error> ioUringErr;
+  std::optional<std::system_error> autoErr;
+  std::thread opener([&] {
+    filtered = FilterIoUringProbe();
+    if (!filtered) { return; }
+    ioUringErr = sink.open(fd, 0, 2, mvi::BipBufferFileSink::Mode::IoUring);
+    autoErr = sink.open(fd, 0, 2, mvi::BipBufferFileSink::Mode::Auto);
+  });
+  opener.join();
+  if (!filtered) {
+    WARN("seccomp filters are not permitted");
+    ::close(fd);
+    std::filesystem::remove(path);
+    return;
+  }
+
+  // An explicit io_uring sink fails, while Auto uses the worker thread
+  CHECK(ioUringErr);
+  REQUIRE_NO_ERROR(autoErr);
+  CHECK(!sink.usingIoUring());
+  {
+    auto reservation = writer.reserve(5);
+    REQUIRE(reservation);
+    std::memcpy(reservation.data(), "hello", reservation.size());
+  }
+  REQUIRE_NO_ERROR(sink.drain());
+  REQUIRE_NO_ERROR(sink.close());
+  CHECK(reader.read().empty());
+  CHECK(ReadFile(path) == "hello");
+
+  ::close(fd);
+  std::filesystem::remove(path);
+}
+#endif // __linux__
+
+TEST_CASE("BipBufferFileSink reports write errors", "[bipbuffer][sink]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  // A read-only descriptor fails every write, the data stays in the buffer
+  const int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+  REQUIRE(fd >= 0);
+  mvi::BipBufferFileSink sink{reader};
+  REQUIRE(sink.open(fd, 0, 0));
+  REQUIRE_NO_ERROR(sink.open(fd, 0, 2));
+  {
+    auto reservation = writer.reserve(5);
+    REQUIRE(reservation);
+    std::memset(reservation.data(), 'x', reservation.size());
+  }
+  auto err = sink.drain();
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::bad_file_descriptor);
+  CHECK(sink.poll());
+  CHECK(sink.close());
+  CHECK(reader.read() == "xxxxx");
+  ::close(fd);
+}
+#endif // _WIN32
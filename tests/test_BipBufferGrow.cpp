@@ -0,0 +1,93 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "SharedMemory.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstring> // for memset
+#include <string_view>
+
+#ifndef _WIN32
+TEST_CASE("BipBuffer grows while in use", "[bipbuffer][grow][shm]") {
+  constexpr const char* NAME = "testgrow";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+  constexpr size_t HEADER_SIZE = sizeof(mvi::BipBufferHeaderV2);
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // The writer and reader use separate mappings of the same memory, as they
+  // would in separate processes. Both reserve room to grow without moving
+  mvi::SharedMemory::Options options;
+  options.reserve = 16 * pageSize;
+  mvi::SharedMemory shmWriter(NAME, pageSize);
+  mvi::SharedMemory shmReader(NAME, pageSize);
+  REQUIRE_NO_ERROR(shmWriter.open(mvi::SharedMemory::Access::ReadWrite, options));
+  REQUIRE_NO_ERROR(shmReader.open(mvi::SharedMemory::Access::ReadWrite, options));
+
+  auto writerLayout = mvi::BipBufferHeaderV2::Create(shmWriter.as<uint8_t>(), pageSize);
+  auto readerLayout = mvi::BipBufferHeaderV2::Attach(shmReader.as<uint8_t>(), pageSize);
+  REQUIRE(writerLayout != nullptr);
+  REQUIRE(readerLayout != nullptr);
+  mvi::BipBufferWriter writer{*writerLayout};
+  mvi::BipBufferReader reader{*readerLayout};
+  const size_t oldSize = pageSize - HEADER_SIZE;
+  const size_t newSize = 4 * pageSize - HEADER_SIZE;
+
+  // Leave data in flight that wraps around the old end of the buffer
+  {
+    auto reservation = writer.reserve(oldSize - 10);
+    REQUIRE(reservation);
+    std::memset(reservation.data(), 'a', reservation.size());
+  }
+  REQUIRE(reader.read().size() == oldSize - 10);
+  REQUIRE(reader.advance(oldSize - 20));
+  {
+    auto reservation = writer.reserve(15);
+    REQUIRE(reservation);
+    std::memset(reservation.data(), 'b', reservation.size());
+  }
+  CHECK(reader.pendingGrowth() == 0);
+
+  // Request the larger buffer once the writer's own mapping covers it
+  REQUIRE(!writer.grow(oldSize));
+  REQUIRE_NO_ERROR(shmWriter.resize(HEADER_SIZE + newSize));
+  REQUIRE(writer.grow(newSize));
+  REQUIRE(!writer.grow(newSize + 1));
+
+  // Until the reader acknowledges, the writer keeps to the old size
+  REQUIRE(!writer.reserve(oldSize));
+  CHECK(writer.bufferSize() == oldSize);
+  REQUIRE(reader.pendingGrowth() == HEADER_SIZE + newSize);
+  REQUIRE_NO_ERROR(shmReader.resize(reader.pendingGrowth()));
+  reader.acknowledgeGrowth();
+  CHECK(reader.pendingGrowth() == 0);
+
+  // The data in flight is read as before
+  CHECK(reader.read() == std::string_view("aaaaaaaaaa"));
+  REQUIRE(reader.advance(10));
+  CHECK(reader.read() == std::string_view("bbbbbbbbbbbbbbb"));
+  REQUIRE(reader.advance(15));
+
+  // Messages larger than the old buffer now fit
+  {
+    auto reservation = writer.reserve(2 * oldSize);
+    REQUIRE(reservation);
+    std::memset(reservation.data(), 'c', reservation.size());
+  }
+  CHECK(writer.bufferSize() == newSize);
+  CHECK(reader.read().size() == 2 * oldSize);
+  REQUIRE(reader.advance(2 * oldSize));
+
+  // Writers and readers attaching later use the grown buffer
+  CHECK(mvi::BipBufferHeaderV2::Attach(shmReader.as<uint8_t>(), pageSize) == nullptr);
+  auto attached = mvi::BipBufferHeaderV2::Attach(shmReader.as<uint8_t>(), shmReader.size());
+  REQUIRE(attached != nullptr);
+  mvi::BipBufferWriter restarted{*attached};
+  CHECK(restarted.bufferSize() == newSize);
+
+  REQUIRE_NO_ERROR(shmReader.close());
+  REQUIRE_NO_ERROR(shmWriter.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+#endif // _WIN32
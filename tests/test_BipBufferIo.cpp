@@ -0,0 +1,165 @@
+#include "BipBufferIo.hpp"
+#include "helpers.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memset
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static std::string ReadAvailable(int fd) {
+  std::array<char, 256> data{};
+  const ssize_t result = ::read(fd, data.data(), data.size());
+  return result > 0 ? std::string(data.data(), size_t(result)) : std::string{};
+}
+
+TEST_CASE("BipBufferWriter reserveAtMost", "[bipbuffer][io]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 16;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE(!writer.reserveAtMost(0));
+  {
+    auto reservation = writer.reserveAtMost(10);
+    REQUIRE(reservation.size() == 10);
+    std::memset(reservation.data(), 'a', reservation.size());
+  }
+  {
+    // Only six bytes are left at the end
+    auto reservation = writer.reserveAtMost(100);
+    REQUIRE(reservation.size() == 6);
+    std::memset(reservation.data(), 'b', reservation.size());
+  }
+  REQUIRE(!writer.reserveAtMost(1));
+
+  // Once the reader frees space at the start, the larger block is picked
+  REQUIRE(reader.read().size() == 16);
+  REQUIRE(reader.advance(12));
+  {
+    auto reservation = writer.reserveAtMost(100);
+    REQUIRE(reservation.size() == 11);
+    CHECK(reservation.data() == layout->buffer());
+    reservation.cancel();
+  }
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBuffer drains to and fills from pipes", "[bipbuffer][io]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 16;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  std::array<int, 2> fds{};
+  REQUIRE(::pipe(fds.data()) == 0);
+  REQUIRE(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  // Nothing to drain, nothing to read yet
+  size_t bytes = 1;
+  REQUIRE_NO_ERROR(mvi::DrainToFd(fds[1], reader, bytes));
+  CHECK(bytes == 0);
+  auto err = mvi::FillFromFd(fds[0], writer, 16, bytes);
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::resource_unavailable_try_again);
+  CHECK(bytes == 0);
+  CHECK(reader.read().empty());
+
+  // Wrap the data around the end, then drain both segments with one writev()
+  REQUIRE(Write(writer, "0123456789"));
+  REQUIRE(reader.read() == "0123456789");
+  REQUIRE(reader.advance(10));
+  REQUIRE(Write(writer, "abcdef"));
+  REQUIRE(Write(writer, "ghi"));
+  REQUIRE(reader.readAll()[1] == "ghi");
+  REQUIRE_NO_ERROR(mvi::DrainToFd(fds[1], reader, bytes));
+  CHECK(bytes == 9);
+  CHECK(reader.read().empty());
+  CHECK(ReadAvailable(fds[0]) == "abcdefghi");
+
+  // A partial fill commits only the bytes read
+  REQUIRE(::write(fds[1], "hello", 5) == 5);
+  REQUIRE_NO_ERROR(mvi::FillFromFd(fds[0], writer, 16, bytes));
+  CHECK(bytes == 5);
+  CHECK(reader.read() == "hello");
+
+  // End of file commits nothing
+  ::close(fds[1]);
+  REQUIRE_NO_ERROR(mvi::FillFromFd(fds[0], writer, 16, bytes));
+  CHECK(bytes == 0);
+  CHECK(reader.read() == "hello");
+
+  // A full buffer is reported before reading
+  REQUIRE(reader.advance(5));
+  REQUIRE(Write(writer, std::string(layout->bufferSize - 8, 'x')));
+  while (writer.reserveAtMost(1)) {}
+  err = mvi::FillFromFd(fds[0], writer, 16, bytes);
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::no_buffer_space);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  ::close(fds[0]);
+}
+
+TEST_CASE("BipBuffer sends to and receives from sockets", "[bipbuffer][io]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> sendBuffer{};
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> receiveBuffer{};
+  auto sendLayout = mvi::BipBufferHeaderV2::Create(sendBuffer.data(), sendBuffer.size());
+  auto receiveLayout = mvi::BipBufferHeaderV2::Create(receiveBuffer.data(), receiveBuffer.size());
+  mvi::BipBufferWriter sendWriter{*sendLayout};
+  mvi::BipBufferReader sendReader{*sendLayout};
+  mvi::BipBufferWriter receiveWriter{*receiveLayout};
+  mvi::BipBufferReader receiveReader{*receiveLayout};
+
+  std::array<int, 2> sockets{};
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()) == 0);
+  REQUIRE(::fcntl(sockets[1], F_SETFL, O_NONBLOCK) == 0);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  // Forward messages from one buffer through the socket into the other one
+  size_t bytes = 0;
+  for (int i = 0; i < 20; ++i) {
+    const std::string message = "message" + std::to_string(i) + ";";
+    REQUIRE(Write(sendWriter, message));
+    REQUIRE_NO_ERROR(mvi::DrainToSocket(sockets[0], sendReader, bytes));
+    CHECK(bytes == message.size());
+    REQUIRE_NO_ERROR(mvi::FillFromSocket(sockets[1], receiveWriter, 64, bytes));
+    CHECK(bytes == message.size());
+    const auto segments = receiveReader.readAll();
+    CHECK(std::string(segments[0]) + std::string(segments[1]) == message);
+    REQUIRE(receiveReader.advance(message.size()));
+  }
+
+  auto err = mvi::FillFromSocket(sockets[1], receiveWriter, 64, bytes);
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::resource_unavailable_try_again);
+
+  // A closed peer is an error rather than SIGPIPE
+  ::close(sockets[1]);
+  REQUIRE(Write(sendWriter, "lost"));
+  err = mvi::DrainToSocket(sockets[0], sendReader, bytes);
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::broken_pipe);
+  CHECK(sendReader.read() == "lost");
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  ::close(sockets[0]);
+}
+#endif // _WIN32
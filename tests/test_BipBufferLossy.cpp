@@ -0,0 +1,132 @@
+#include "BipBufferLossyHeader.hpp"
+#include "BipBufferLossyReader.hpp"
+#include "BipBufferLossyWriter.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstring> // for memcpy
+#include <string>
+#include <thread>
+
+constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
+
+TEST_CASE("BipBufferLossy basic lifecycle", "[bipbuffer][lossy]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferLossyHeader) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  REQUIRE(mvi::BipBufferLossyHeader::Attach(buffer.data(), buffer.size()) == nullptr);
+  auto layout = mvi::BipBufferLossyHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+  REQUIRE(layout->bufferSize == 64);
+  REQUIRE(mvi::BipBufferLossyHeader::Attach(buffer.data(), buffer.size()) == layout);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferLossyWriter writer{*layout};
+  mvi::BipBufferLossyReader reader{*layout};
+  std::array<char, 64> data{};
+
+  // Nothing to read
+  REQUIRE(!reader.read(data.data(), data.size()));
+
+  // The payload and record header must fit in the buffer
+  REQUIRE(!writer.write(data.data(), 64 - mvi::BipBufferLossyHeader::RECORD_HEADER_SIZE + 1));
+  REQUIRE(writer.sequence() == 0);
+
+  REQUIRE(writer.write("hello", 5));
+  REQUIRE(writer.sequence() == 1);
+  REQUIRE(reader.read(data.data(), data.size()) == 5);
+  REQUIRE(std::string(data.data(), 5) == "hello");
+  REQUIRE(reader.sequence() == 0);
+  REQUIRE(!reader.read(data.data(), data.size()));
+
+  // Long messages are truncated to the capacity but report their full length
+  REQUIRE(writer.write("0123456789", 10));
+  REQUIRE(reader.read(data.data(), 4) == 10);
+  REQUIRE(std::string(data.data(), 4) == "0123");
+
+  // The writer never fails when the reader falls behind, it overwrites the
+  // oldest records, wrapping around the end of the buffer with padding
+  for (size_t i = 0; i < 10; ++i) {
+    const std::string message = "msg" + std::to_string(i);
+    REQUIRE(writer.write(message.data(), message.size()));
+  }
+  REQUIRE(layout->head.load(ORDER_STRICT) - layout->tail.load(ORDER_STRICT) <= 64);
+
+  // The reader skips to the oldest intact record and accounts for the loss
+  REQUIRE(reader.read(data.data(), data.size()) == 4);
+  const uint64_t first = reader.sequence();
+  REQUIRE(first > 2);
+  REQUIRE(reader.lostMessages() == first - 2);
+  REQUIRE(reader.lostBytes() > 0);
+  REQUIRE(std::string(data.data(), 4) == "msg" + std::to_string(first - 2));
+  while (reader.read(data.data(), data.size())) {}
+  REQUIRE(reader.sequence() == 11);
+  REQUIRE(std::string(data.data(), 4) == "msg9");
+  REQUIRE(reader.lostMessages() == first - 2);
+
+  // A reader constructed later starts at the oldest intact record
+  mvi::BipBufferLossyReader lateReader{*layout};
+  REQUIRE(lateReader.read(data.data(), data.size()) == 4);
+  REQUIRE(lateReader.sequence() == first);
+  REQUIRE(lateReader.lostMessages() == 0);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBufferLossy concurrent overrun", "[bipbuffer][lossy][concurrent]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferLossyHeader) + 512;
+  constexpr uint64_t MESSAGE_COUNT = 200000;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferLossyHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  mvi::BipBufferLossyWriter writer{*layout};
+  mvi::BipBufferLossyReader reader{*layout};
+
+  // Each message holds its sequence number, repeated up to a variable length
+  std::atomic<bool> done{false};
+  auto writerFunc = [&]() {
+    std::array<uint64_t, 8> message{};
+    for (uint64_t i = 0; i < MESSAGE_COUNT; ++i) {
+      message.fill(i);
+      (void)writer.write(message.data(), size_t(1 + i % message.size()) * sizeof(uint64_t));
+    }
+    done = true;
+  };
+
+  size_t errors = 0;
+  uint64_t received = 0;
+  uint64_t firstSequence = 0;
+  auto readerFunc = [&]() {
+    std::array<uint64_t, 8> message{};
+    for (;;) {
+      const bool finished = done;
+      const auto length = reader.read(message.data(), sizeof(message));
+      if (!length) {
+        if (finished) { break; }
+        std::this_thread::yield();
+        continue;
+      }
+      const uint64_t sequence = reader.sequence();
+      if (received == 0) { firstSequence = sequence; }
+      ++received;
+      if (*length != (1 + sequence % message.size()) * sizeof(uint64_t)) { ++errors; }
+      for (size_t j = 0; j < *length / sizeof(uint64_t); ++j) {
+        if (message[j] != sequence) { ++errors; }
+      }
+    }
+  };
+
+  std::thread writerThread(writerFunc);
+  std::thread readerThread(readerFunc);
+  writerThread.join();
+  readerThread.join();
+
+  REQUIRE(errors == 0);
+  REQUIRE(reader.sequence() == MESSAGE_COUNT - 1);
+  REQUIRE(firstSequence + received + reader.lostMessages() == MESSAGE_COUNT);
+}
@@ -1,4 +1,5 @@
 #include "BipBufferHeader.hpp"
+#include "BipBufferHeaderV2.hpp"
 
 #include <catch2/catch_all.hpp>
 
@@ -27,3 +28,67 @@ TEST_CASE("BipBufferHeader Create", "[bipbuffer]") {
   CHECK(layout->write.load(std::memory_order_seq_cst) == WRITE_POS);
   CHECK(layout->last.load(std::memory_order_seq_cst) == LAST_POS);
 }
+
+TEST_CASE("BipBufferHeaderV2 Create", "[bipbuffer]") {
+  STATIC_REQUIRE(sizeof(mvi::BipBufferHeaderV2) == 3 * mvi::CACHE_LINE_SIZE);
+  STATIC_REQUIRE(alignof(mvi::BipBufferHeaderV2) == mvi::CACHE_LINE_SIZE);
+
+  const size_t bufferSize = 256;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, bufferSize> buffer{};
+
+  // Misaligned memory is rejected
+  REQUIRE(mvi::BipBufferHeaderV2::Create(buffer.data() + 1, buffer.size() - 1) == nullptr);
+
+  // Too small for the header plus at least one byte of buffer
+  REQUIRE(mvi::BipBufferHeaderV2::Create(buffer.data(), sizeof(mvi::BipBufferHeaderV2)) == nullptr);
+
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+
+  REQUIRE(layout != nullptr);
+  CHECK(layout->magic == mvi::BipBufferHeaderV2::MAGIC);
+  CHECK(layout->version == mvi::BipBufferHeaderV2::VERSION);
+  CHECK(layout->bufferSize == bufferSize - sizeof(mvi::BipBufferHeaderV2));
+  CHECK(layout->buffer() == buffer.data() + sizeof(mvi::BipBufferHeaderV2));
+
+  // Producer and consumer indices live on separate cache lines
+  const auto base = reinterpret_cast<uintptr_t>(layout);
+  const auto writeOffset = reinterpret_cast<uintptr_t>(&layout->write) - base;
+  const auto lastOffset = reinterpret_cast<uintptr_t>(&layout->last) - base;
+  const auto readOffset = reinterpret_cast<uintptr_t>(&layout->read) - base;
+  CHECK(writeOffset / mvi::CACHE_LINE_SIZE == 1);
+  CHECK(lastOffset / mvi::CACHE_LINE_SIZE == 1);
+  CHECK(readOffset / mvi::CACHE_LINE_SIZE == 2);
+
+  constexpr size_t READ_POS = 1;
+  constexpr size_t WRITE_POS = 512;
+  constexpr size_t LAST_POS = 1024;
+
+  layout->read = READ_POS;
+  layout->write = WRITE_POS;
+  layout->last = LAST_POS;
+
+  CHECK(layout->read.load(std::memory_order_seq_cst) == READ_POS);
+  CHECK(layout->write.load(std::memory_order_seq_cst) == WRITE_POS);
+  CHECK(layout->last.load(std::memory_order_seq_cst) == LAST_POS);
+}
+
+TEST_CASE("BipBufferHeaderV2 Attach", "[bipbuffer]") {
+  const size_t bufferSize = 256;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, bufferSize> buffer{};
+
+  // Zeroed memory and a v1 header are not recognized as a v2 header
+  REQUIRE(mvi::BipBufferHeaderV2::Attach(buffer.data(), buffer.size()) == nullptr);
+  REQUIRE(mvi::BipBufferHeader::Create(buffer.data(), buffer.size()) != nullptr);
+  REQUIRE(mvi::BipBufferHeaderV2::Attach(buffer.data(), buffer.size()) == nullptr);
+
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+  layout->write = 7;
+
+  auto attached = mvi::BipBufferHeaderV2::Attach(buffer.data(), buffer.size());
+  REQUIRE(attached == layout);
+  CHECK(attached->write.load(std::memory_order_seq_cst) == 7);
+
+  // The memory must be large enough for the recorded buffer size
+  REQUIRE(mvi::BipBufferHeaderV2::Attach(buffer.data(), buffer.size() - 1) == nullptr);
+}
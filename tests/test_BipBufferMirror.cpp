@@ -0,0 +1,144 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "SharedMemory.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memset
+#include <string>
+#include <thread>
+
+TEST_CASE("BipBufferHeaderV2 CreateMirrored", "[bipbuffer][mirror]") {
+  constexpr size_t HEADER_SIZE = sizeof(mvi::BipBufferHeaderV2);
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, 1024> buffer{};
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  // The buffer offset must leave room for the header and keep cache line alignment
+  REQUIRE(mvi::BipBufferHeaderV2::CreateMirrored(buffer.data(), 1024, HEADER_SIZE - 64) == nullptr);
+  REQUIRE(mvi::BipBufferHeaderV2::CreateMirrored(buffer.data(), 1024, HEADER_SIZE + 1) == nullptr);
+  REQUIRE(mvi::BipBufferHeaderV2::CreateMirrored(buffer.data(), 512, 512) == nullptr);
+
+  // Create() does not accept the flag, mirroring needs CreateMirrored()
+  REQUIRE(mvi::BipBufferHeaderV2::Create(
+            buffer.data(), 1024, mvi::BipBufferHeaderV2::FLAG_MIRRORED) == nullptr);
+
+  auto layout = mvi::BipBufferHeaderV2::CreateMirrored(buffer.data(), 1024, 512);
+  REQUIRE(layout != nullptr);
+  CHECK(layout->bufferSize == 512);
+  CHECK(layout->buffer() == buffer.data() + 512);
+  CHECK(layout->flags == mvi::BipBufferHeaderV2::FLAG_MIRRORED);
+
+  auto attached = mvi::BipBufferHeaderV2::Attach(buffer.data(), 1024);
+  REQUIRE(attached == layout);
+  CHECK(attached->buffer() == buffer.data() + 512);
+  REQUIRE(mvi::BipBufferHeaderV2::Attach(buffer.data(), 1023) == nullptr);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+#ifndef _WIN32
+TEST_CASE("BipBuffer mirrored reservations never wrap", "[bipbuffer][mirror][shm]") {
+  constexpr const char* NAME = "testmirror";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+  const size_t size = 2 * pageSize;
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+  mvi::SharedMemory shm(NAME, size);
+  REQUIRE_NO_ERROR(shm.open(mvi::SharedMemory::Access::ReadWrite, {true, pageSize}));
+
+  auto layout = mvi::BipBufferHeaderV2::CreateMirrored(shm.as<uint8_t>(), size, pageSize);
+  REQUIRE(layout != nullptr);
+  REQUIRE(layout->bufferSize == pageSize);
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  // Everything except the byte separating full from empty can be reserved at once
+  REQUIRE(!writer.reserve(pageSize));
+  {
+    auto reservation = writer.reserve(pageSize - 1);
+    REQUIRE(reservation);
+    std::memset(reservation.data(), 'a', reservation.size());
+  }
+  REQUIRE(reader.read().size() == pageSize - 1);
+  REQUIRE(reader.advance(pageSize - 1));
+
+  // With the write position just before the end, a reservation of nearly the
+  // full buffer still fits and extends into the mirror
+  {
+    auto reservation = writer.reserve(pageSize - 1);
+    REQUIRE(reservation);
+    CHECK(reservation.data() == layout->buffer() + pageSize - 1);
+    std::memset(reservation.data(), 'b', reservation.size());
+  }
+  CHECK(layout->last.load() == 0);
+
+  // The reader sees the wrapped data as a single segment
+  auto segments = reader.readAll();
+  CHECK(segments[0] == std::string(pageSize - 1, 'b'));
+  CHECK(segments[1].empty());
+  CHECK(layout->buffer()[0] == 'b');
+  REQUIRE(!reader.advance(pageSize));
+  REQUIRE(reader.advance(pageSize - 1));
+  CHECK(reader.offset() == pageSize - 2);
+  CHECK(reader.read().empty());
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE_NO_ERROR(shm.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("BipBuffer mirrored concurrent transfer", "[bipbuffer][mirror][concurrent][shm]") {
+  constexpr const char* NAME = "testmirrorthreads";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+  const size_t size = 2 * pageSize;
+  constexpr size_t MESSAGES = 20000;
+  constexpr size_t MESSAGE_SIZE = 100; // Not a divisor of the buffer size, so messages wrap
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+  mvi::SharedMemory shm(NAME, size);
+  REQUIRE_NO_ERROR(shm.open(mvi::SharedMemory::Access::ReadWrite, {true, pageSize}));
+  auto layout = mvi::BipBufferHeaderV2::CreateMirrored(shm.as<uint8_t>(), size, pageSize);
+  REQUIRE(layout != nullptr);
+
+  std::thread producer([layout] {
+    mvi::BipBufferWriter writer{*layout};
+    for (size_t i = 0; i < MESSAGES;) {
+      auto reservation = writer.reserve(MESSAGE_SIZE);
+      if (!reservation) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::memset(reservation.data(), int('A' + i % 26), MESSAGE_SIZE);
+      ++i;
+    }
+  });
+
+  // Every read returns whole messages, even across the end of the buffer
+  mvi::BipBufferReader reader{*layout};
+  size_t received = 0;
+  size_t mismatches = 0;
+  while (received < MESSAGES) {
+    const std::string_view data = reader.read();
+    if (data.size() < MESSAGE_SIZE) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (const char c : data.substr(0, MESSAGE_SIZE)) {
+      if (c != char('A' + received % 26)) { ++mismatches; }
+    }
+    REQUIRE(reader.advance(MESSAGE_SIZE));
+    ++received;
+  }
+  producer.join();
+  CHECK(mismatches == 0);
+
+  REQUIRE_NO_ERROR(shm.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+#endif // _WIN32
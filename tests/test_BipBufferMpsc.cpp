@@ -0,0 +1,268 @@
+#include "BipBufferMpscHeader.hpp"
+#include "BipBufferMpscReader.hpp"
+#include "BipBufferMpscWriter.hpp"
+#include "SharedMemory.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring> // for memcpy
+#include <thread>
+#include <vector>
+
+#if defined(__SANITIZE_THREAD__)
+#define TSAN_ENABLED 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define TSAN_ENABLED 1
+#endif
+#endif
+
+constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
+
+TEST_CASE("BipBufferMpscHeader Create and Attach", "[bipbuffer][mpsc]") {
+  constexpr size_t HEADER_SIZE = sizeof(mvi::BipBufferMpscHeader);
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, HEADER_SIZE + 64 + 7> buffer{};
+  buffer.back() = 0xFF;
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE(mvi::BipBufferMpscHeader::Create(nullptr, buffer.size()) == nullptr);
+  REQUIRE(mvi::BipBufferMpscHeader::Create(buffer.data(), HEADER_SIZE + 8) == nullptr);
+  REQUIRE(mvi::BipBufferMpscHeader::Create(buffer.data() + 8, buffer.size() - 8) == nullptr);
+  REQUIRE(mvi::BipBufferMpscHeader::Attach(buffer.data(), buffer.size()) == nullptr);
+
+  // The buffer size is rounded down to the record alignment
+  auto layout = mvi::BipBufferMpscHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+  REQUIRE(layout->bufferSize == 64);
+  REQUIRE(layout->claim.load(ORDER_STRICT) == 0);
+  REQUIRE(layout->read.load(ORDER_STRICT) == 0);
+  REQUIRE(buffer.back() == 0xFF);
+
+  REQUIRE(mvi::BipBufferMpscHeader::Attach(buffer.data(), buffer.size()) == layout);
+  REQUIRE(mvi::BipBufferMpscHeader::Attach(buffer.data(), HEADER_SIZE + 56) == nullptr);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBufferMpsc basic lifecycle", "[bipbuffer][mpsc]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferMpscHeader) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferMpscHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == 64);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferMpscWriter writer1{*layout};
+  mvi::BipBufferMpscWriter writer2{*layout};
+  mvi::BipBufferMpscReader reader{*layout};
+
+  // Nothing to read
+  REQUIRE(!reader.read());
+  REQUIRE(!reader.advance());
+
+  // The payload and record header must fit in the buffer
+  REQUIRE(!writer1.reserve(64 - mvi::BipBufferMpscHeader::RECORD_HEADER_SIZE + 1));
+
+  // Records are padded to the record alignment
+  auto reservation1 = writer1.reserve(5);
+  auto reservation2 = writer2.reserve(0);
+  REQUIRE(reservation1);
+  REQUIRE(reservation2);
+  REQUIRE(reservation1.size() == 5);
+  REQUIRE(reservation2.size() == 0);
+  REQUIRE(layout->claim.load(ORDER_STRICT) == 24);
+
+  // A record committed out of order is held back by the uncommitted one before it
+  reservation2.commit();
+  REQUIRE(!reservation2);
+  REQUIRE(!reader.read());
+
+  std::memcpy(reservation1.data(), "hello", 5);
+  reservation1.commit();
+  auto data = reader.read();
+  REQUIRE(data);
+  REQUIRE(*data == "hello");
+  REQUIRE(reader.advance());
+  REQUIRE(!reader.advance());
+
+  // Committed records may be empty
+  data = reader.read();
+  REQUIRE(data);
+  REQUIRE(data->empty());
+  REQUIRE(reader.advance());
+  REQUIRE(!reader.read());
+  REQUIRE(reader.position() == 24);
+  REQUIRE(layout->read.load(ORDER_STRICT) == 24);
+
+  // Consumed records are zeroed
+  REQUIRE(std::all_of(layout->buffer(), layout->buffer() + 24, [](uint8_t b) { return b == 0; }));
+
+  // Canceled records are skipped by the reader
+  auto reservation = writer1.reserve(8);
+  REQUIRE(reservation);
+  reservation.cancel();
+  REQUIRE(reservation.size() == 0);
+  reservation.commit();
+  REQUIRE(!reader.read());
+  REQUIRE(reader.position() == 40);
+
+  // A record that does not fit before the end of the buffer wraps around, and
+  // the end of the buffer is skipped by the reader as padding
+  reservation = writer2.reserve(20);
+  REQUIRE(reservation);
+  REQUIRE(reservation.data() == layout->buffer() + mvi::BipBufferMpscHeader::RECORD_HEADER_SIZE);
+  REQUIRE(layout->claim.load(ORDER_STRICT) == 96);
+  std::memcpy(reservation.data(), "0123456789abcdefghij", 20);
+  reservation.commit();
+  data = reader.read();
+  REQUIRE(data);
+  REQUIRE(*data == "0123456789abcdefghij");
+  REQUIRE(reader.position() == 64);
+  REQUIRE(reader.advance());
+  REQUIRE(reader.position() == 96);
+
+  // Reserve an upper bound and truncate it to the actual length
+  reservation = writer1.reserve(8);
+  REQUIRE(reservation);
+  std::memcpy(reservation.data(), "abc", 3);
+  REQUIRE_FALSE(reservation.truncate(9));
+  REQUIRE(reservation.truncate(3));
+  REQUIRE(reservation.size() == 3);
+  reservation = writer1.reserve(8); // Move-assignment commits the truncated record
+  REQUIRE(reservation);
+
+  // Fill the rest of the buffer
+  auto full = writer2.reserve(24);
+  REQUIRE(full);
+  REQUIRE(!writer1.reserve(0));
+  reservation.commit();
+  full.commit();
+
+  data = reader.read();
+  REQUIRE(data);
+  REQUIRE(*data == "abc");
+  REQUIRE(reader.advance());
+  REQUIRE(writer1.reserve(0));
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+template <typename Writers>
+static void RunProducersAndConsumer(Writers& writers, mvi::BipBufferMpscReader& reader) {
+  constexpr size_t MESSAGE_COUNT = 20000;
+  const size_t producerCount = writers.size();
+
+  // Each message holds its producer and sequence number, repeated up to a variable length
+  auto writerFunc = [&](size_t producer) {
+    mvi::BipBufferMpscWriter& writer = writers[producer];
+    for (size_t i = 0; i < MESSAGE_COUNT; ++i) {
+      const std::array<size_t, 2> value{producer, i};
+      const size_t count = 1 + i % 5;
+      auto reservation = writer.reserve(sizeof(value) * count);
+      while (!reservation) {
+        std::this_thread::yield();
+        reservation = writer.reserve(sizeof(value) * count);
+      }
+      for (size_t j = 0; j < count; ++j) {
+        std::memcpy(reservation.data() + j * sizeof(value), value.data(), sizeof(value));
+      }
+    }
+  };
+
+  size_t errors = 0;
+  auto readerFunc = [&]() {
+    std::vector<size_t> expected(producerCount, 0);
+    size_t remaining = producerCount * MESSAGE_COUNT;
+    while (remaining > 0) {
+      const auto data = reader.read();
+      if (!data) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::array<size_t, 2> value{};
+      std::memcpy(value.data(), data->data(), sizeof(value));
+      const size_t producer = value[0];
+      if (producer >= producerCount || value[1] != expected[producer]) {
+        ++errors;
+        break;
+      }
+      if (data->size() != sizeof(value) * (1 + value[1] % 5)) { ++errors; }
+      for (size_t j = sizeof(value); j < data->size(); j += sizeof(value)) {
+        if (std::memcmp(data->data() + j, value.data(), sizeof(value)) != 0) { ++errors; }
+      }
+      ++expected[producer];
+      --remaining;
+      if (!reader.advance()) { ++errors; }
+    }
+  };
+
+  std::vector<std::thread> writerThreads;
+  for (size_t producer = 0; producer < producerCount; ++producer) {
+    writerThreads.emplace_back(writerFunc, producer);
+  }
+  std::thread readerThread(readerFunc);
+  for (auto& thread : writerThreads) {
+    thread.join();
+  }
+  readerThread.join();
+
+  REQUIRE(errors == 0);
+  REQUIRE(!reader.read());
+}
+
+TEST_CASE("BipBufferMpsc concurrent producers", "[bipbuffer][mpsc][concurrent]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferMpscHeader) + 1024;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferMpscHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  std::vector<mvi::BipBufferMpscWriter> writers;
+  for (size_t producer = 0; producer < 4; ++producer) {
+    writers.emplace_back(*layout);
+  }
+  mvi::BipBufferMpscReader reader{*layout};
+  RunProducersAndConsumer(writers, reader);
+}
+
+TEST_CASE("BipBufferMpsc over SharedMemory", "[bipbuffer][mpsc][concurrent][shm]") {
+  constexpr const char* NAME = "testmpsc";
+  constexpr size_t SIZE = sizeof(mvi::BipBufferMpscHeader) + 4096;
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // The writers and the reader use separate mappings of the same memory, as
+  // they would in separate processes
+  mvi::SharedMemory shmWriter(NAME, SIZE);
+  mvi::SharedMemory shmReader(NAME, SIZE);
+  REQUIRE_NO_ERROR(shmReader.open(mvi::SharedMemory::Access::ReadWrite));
+  REQUIRE_NO_ERROR(shmWriter.open(mvi::SharedMemory::Access::ReadWrite));
+
+  auto readerLayout = mvi::BipBufferMpscHeader::Create(shmReader.as<uint8_t>(), SIZE);
+  REQUIRE(readerLayout != nullptr);
+#ifdef TSAN_ENABLED
+  // ThreadSanitizer tracks synchronization by address and cannot follow it
+  // across two mappings of the same memory, so both sides share one mapping
+  auto writerLayout = mvi::BipBufferMpscHeader::Attach(shmReader.as<uint8_t>(), SIZE);
+#else
+  auto writerLayout = mvi::BipBufferMpscHeader::Attach(shmWriter.as<uint8_t>(), SIZE);
+#endif
+  REQUIRE(writerLayout != nullptr);
+  REQUIRE(writerLayout->bufferSize == 4096);
+
+  std::vector<mvi::BipBufferMpscWriter> writers;
+  for (size_t producer = 0; producer < 3; ++producer) {
+    writers.emplace_back(*writerLayout);
+  }
+  mvi::BipBufferMpscReader reader{*readerLayout};
+  RunProducersAndConsumer(writers, reader);
+
+  REQUIRE_NO_ERROR(shmWriter.close());
+  REQUIRE_NO_ERROR(shmReader.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
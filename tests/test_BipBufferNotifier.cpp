@@ -0,0 +1,133 @@
+#include "BipBufferNotifier.hpp"
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "UnixSocket.hpp"
+#include "helpers.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+TEST_CASE("BipBufferNotifier signals armed readers", "[bipbuffer][notifier]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(
+    buffer.data(), buffer.size(), mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  mvi::BipBufferNotifier notifier;
+  CHECK(notifier.fd() == -1);
+  REQUIRE_NO_ERROR(notifier.create());
+  REQUIRE(notifier.fd() >= 0);
+  writer.setNotifier(&notifier);
+
+  // Nothing is signaled while the reader is not armed
+  REQUIRE(Write(writer, "abc"));
+  REQUIRE(notifier.drain() == 0);
+
+  // Arming fails while there is unread data
+  REQUIRE(!reader.arm());
+  REQUIRE(reader.read() == "abc");
+  REQUIRE(reader.advance(3));
+
+  // Only the first publish after arming signals the notifier
+  REQUIRE(reader.arm());
+  REQUIRE(Write(writer, "def"));
+  REQUIRE(Write(writer, "ghi"));
+  REQUIRE(notifier.drain() == 1);
+  REQUIRE(notifier.drain() == 0);
+  REQUIRE(reader.read() == "defghi");
+
+  // Without wakeups the reader can not be armed
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> plainBuffer{};
+  auto plainLayout = mvi::BipBufferHeaderV2::Create(plainBuffer.data(), plainBuffer.size());
+  mvi::BipBufferReader plainReader{*plainLayout};
+  REQUIRE(!plainReader.arm());
+}
+
+TEST_CASE("BipBufferNotifier multiplexes buffers with epoll", "[bipbuffer][notifier]") {
+  constexpr size_t BUFFER_COUNT = 4;
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 64;
+  using Buffer = std::array<uint8_t, BUFFER_SIZE>;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<Buffer, BUFFER_COUNT> buffers{};
+
+  const int epoll = ::epoll_create1(EPOLL_CLOEXEC);
+  REQUIRE(epoll >= 0);
+
+  std::vector<mvi::BipBufferWriter> writers;
+  std::vector<mvi::BipBufferReader> readers;
+  std::array<mvi::BipBufferNotifier, BUFFER_COUNT> notifiers;
+  for (size_t i = 0; i < BUFFER_COUNT; ++i) {
+    auto layout = mvi::BipBufferHeaderV2::Create(
+      buffers[i].data(), BUFFER_SIZE, mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+    writers.emplace_back(*layout);
+    readers.emplace_back(*layout);
+    REQUIRE_NO_ERROR(notifiers[i].create());
+    writers[i].setNotifier(&notifiers[i]);
+    REQUIRE(readers[i].arm());
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = i;
+    REQUIRE(::epoll_ctl(epoll, EPOLL_CTL_ADD, notifiers[i].fd(), &event) == 0);
+  }
+
+  std::array<epoll_event, BUFFER_COUNT> events{};
+  REQUIRE(::epoll_wait(epoll, events.data(), int(events.size()), 0) == 0);
+
+  // Only the buffers that were written to are reported
+  REQUIRE(Write(writers[1], "one"));
+  REQUIRE(Write(writers[3], "three"));
+  const int count = ::epoll_wait(epoll, events.data(), int(events.size()), 1000);
+  REQUIRE(count == 2);
+  std::array<bool, BUFFER_COUNT> ready{};
+  for (int i = 0; i < count; ++i) {
+    const size_t index = size_t(events[size_t(i)].data.u64);
+    ready[index] = true;
+    REQUIRE(notifiers[index].drain() == 1);
+    REQUIRE(!readers[index].read().empty());
+  }
+  REQUIRE(ready == std::array<bool, BUFFER_COUNT>{false, true, false, true});
+  REQUIRE(::epoll_wait(epoll, events.data(), int(events.size()), 0) == 0);
+
+  ::close(epoll);
+}
+
+TEST_CASE("BipBufferNotifier shared over a Unix socket", "[bipbuffer][notifier]") {
+  std::array<int, 2> sockets{};
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) == 0);
+
+  mvi::BipBufferNotifier writerNotifier;
+  REQUIRE_NO_ERROR(writerNotifier.create());
+  REQUIRE_NO_ERROR(mvi::SendFileDescriptor(sockets[0], writerNotifier.fd()));
+
+  int fd = -1;
+  REQUIRE_NO_ERROR(mvi::ReceiveFileDescriptor(sockets[1], fd));
+  REQUIRE(fd >= 0);
+  REQUIRE(fd != writerNotifier.fd());
+
+  mvi::BipBufferNotifier readerNotifier;
+  REQUIRE_NO_ERROR(readerNotifier.adopt(fd));
+  REQUIRE(readerNotifier.drain() == 0);
+  writerNotifier.signal();
+  writerNotifier.signal();
+  REQUIRE(readerNotifier.drain() == 2);
+
+  // A closed socket is reported as an error
+  ::close(sockets[0]);
+  REQUIRE(mvi::ReceiveFileDescriptor(sockets[1], fd).has_value());
+  ::close(sockets[1]);
+
+  REQUIRE(readerNotifier.adopt(-1).has_value());
+  REQUIRE(readerNotifier.fd() == -1);
+}
+#endif // __linux__
@@ -101,3 +101,76 @@ TEST_CASE("BipBufferReader basic lifecycle", "[bipbuffer]") {
 
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
 }
+
+TEST_CASE("BipBufferReader readAll across the wraparound", "[bipbuffer]") {
+  constexpr size_t BUFFER_SIZE = 64;
+  constexpr size_t ARRAY_SIZE = 256;
+
+  std::array<uint8_t, ARRAY_SIZE> testData{};
+  for (size_t i = 0; i < testData.size(); i++) {
+    testData.at(i) = uint8_t(i);
+  }
+
+  std::array<uint8_t, BUFFER_SIZE> buffer{};
+  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == 32);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferReader reader{*layout};
+
+  // Nothing to read
+  auto spans = reader.readAll();
+  REQUIRE(spans[0].empty());
+  REQUIRE(spans[1].empty());
+
+  // Contiguous data is returned in the first segment only
+  std::memcpy(layout->buffer(), testData.data(), 30);
+  layout->last.store(30, ORDER_STRICT);
+  layout->write.store(30, ORDER_STRICT);
+  spans = reader.readAll();
+  REQUIRE(spans[0].size() == 30);
+  REQUIRE(spans[1].empty());
+  REQUIRE(reader.advance(20));
+
+  // Simulate a wraparound write: bytes 20..30 are the tail, 0..5 the head
+  std::memcpy(layout->buffer(), testData.data() + 30, 5);
+  layout->write.store(5, ORDER_STRICT);
+  spans = reader.readAll();
+  REQUIRE(spans[0].size() == 10);
+  REQUIRE(std::memcmp(spans[0].data(), testData.data() + 20, spans[0].size()) == 0);
+  REQUIRE(spans[1].size() == 5);
+  REQUIRE(std::memcmp(spans[1].data(), testData.data() + 30, spans[1].size()) == 0);
+
+  // Can't advance past the end of the head
+  REQUIRE_FALSE(reader.advance(16));
+  REQUIRE(layout->read.load(ORDER_STRICT) == 20);
+
+  // Advance across both segments with a single store
+  REQUIRE(reader.advance(13));
+  REQUIRE(layout->read.load(ORDER_STRICT) == 3);
+  spans = reader.readAll();
+  REQUIRE(spans[0].size() == 2);
+  REQUIRE(spans[0].data()[0] == char(testData[33]));
+  REQUIRE(spans[1].empty());
+  REQUIRE(reader.advance(2));
+
+  // Wraparound where the tail has already been consumed up to `last`
+  std::memcpy(layout->buffer() + 5, testData.data() + 35, 25);
+  layout->last.store(30, ORDER_STRICT);
+  layout->write.store(30, ORDER_STRICT);
+  spans = reader.readAll();
+  REQUIRE(spans[0].size() == 25);
+  REQUIRE(reader.advance(25));
+  REQUIRE(layout->read.load(ORDER_STRICT) == 30);
+  std::memcpy(layout->buffer(), testData.data() + 60, 4);
+  layout->write.store(4, ORDER_STRICT);
+  spans = reader.readAll();
+  REQUIRE(spans[0].size() == 4);
+  REQUIRE(std::memcmp(spans[0].data(), testData.data() + 60, spans[0].size()) == 0);
+  REQUIRE(spans[1].empty());
+  REQUIRE(reader.advance(4));
+  REQUIRE(layout->read.load(ORDER_STRICT) == 4);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
@@ -0,0 +1,158 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferStatistics.hpp"
+#include "BipBufferWriter.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstdint>
+
+TEST_CASE("BipBufferStatistics layout", "[bipbuffer][statistics]") {
+  STATIC_REQUIRE(sizeof(mvi::BipBufferStatistics) == 2 * mvi::CACHE_LINE_SIZE);
+
+  constexpr uint32_t FLAGS = mvi::BipBufferHeaderV2::FLAG_STATISTICS;
+  constexpr size_t HEADER_SIZE = sizeof(mvi::BipBufferHeaderV2) + sizeof(mvi::BipBufferStatistics);
+  CHECK(mvi::BipBufferHeaderV2::HeaderSize(0) == sizeof(mvi::BipBufferHeaderV2));
+  CHECK(mvi::BipBufferHeaderV2::HeaderSize(FLAGS) == HEADER_SIZE);
+
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, HEADER_SIZE + 64> buffer{};
+
+  // Without the flag there are no counters and the buffer follows the header
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+  CHECK(layout->statistics() == nullptr);
+
+  // Too small for the header, the counters and at least one byte of buffer
+  REQUIRE(mvi::BipBufferHeaderV2::Create(buffer.data(), HEADER_SIZE, FLAGS) == nullptr);
+
+  layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size(), FLAGS);
+  REQUIRE(layout != nullptr);
+  CHECK(layout->bufferOffset == HEADER_SIZE);
+  CHECK(layout->bufferSize == 64);
+  auto statistics = layout->statistics();
+  REQUIRE(statistics != nullptr);
+
+  // The writer's and the reader's counters live on separate cache lines
+  const auto base = reinterpret_cast<uintptr_t>(layout);
+  const auto committedOffset = reinterpret_cast<uintptr_t>(&statistics->bytesCommitted) - base;
+  const auto highWaterOffset = reinterpret_cast<uintptr_t>(&statistics->highWaterMark) - base;
+  const auto consumedOffset = reinterpret_cast<uintptr_t>(&statistics->bytesConsumed) - base;
+  CHECK(committedOffset / mvi::CACHE_LINE_SIZE == 3);
+  CHECK(highWaterOffset / mvi::CACHE_LINE_SIZE == 3);
+  CHECK(consumedOffset / mvi::CACHE_LINE_SIZE == 4);
+
+  // Another process attaching to the buffer finds the same counters
+  auto attached = mvi::BipBufferHeaderV2::Attach(buffer.data(), buffer.size());
+  REQUIRE(attached == layout);
+  CHECK(attached->statistics() == statistics);
+
+  // A mirrored buffer must leave room for the counters before the buffer
+  CHECK(mvi::BipBufferHeaderV2::CreateMirrored(
+          buffer.data(), buffer.size(), sizeof(mvi::BipBufferHeaderV2), FLAGS) == nullptr);
+}
+
+TEST_CASE("BipBufferStatistics counts the traffic", "[bipbuffer][statistics]") {
+  constexpr size_t BUFFER_SIZE = 64;
+  constexpr uint32_t FLAGS = mvi::BipBufferHeaderV2::FLAG_STATISTICS;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t,
+    sizeof(mvi::BipBufferHeaderV2) + sizeof(mvi::BipBufferStatistics) + BUFFER_SIZE>
+    buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size(), FLAGS);
+  REQUIRE(layout != nullptr);
+  const auto* statistics = layout->statistics();
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  auto counters = statistics->load();
+  CHECK(counters.bytesCommitted == 0);
+  CHECK(counters.highWaterMark == 0);
+
+  REQUIRE(writer.reserve(40));
+  counters = statistics->load();
+  CHECK(counters.bytesCommitted == 40);
+  CHECK(counters.messagesCommitted == 1);
+  CHECK(counters.highWaterMark == 40);
+  CHECK(counters.reserveFailures == 0);
+
+  // Full: 24 bytes left at the end, none before the read position
+  REQUIRE(!writer.reserve(30));
+  CHECK(statistics->load().reserveFailures == 1);
+
+  REQUIRE(reader.read().size() == 40);
+  REQUIRE(reader.advance(30));
+  REQUIRE(!reader.advance(11));
+  counters = statistics->load();
+  CHECK(counters.bytesConsumed == 30);
+  CHECK(counters.advances == 1);
+
+  // Still neither 30 bytes at the end nor before the read position
+  REQUIRE(!writer.reserve(30));
+  CHECK(statistics->load().reserveFailures == 2);
+
+  REQUIRE(writer.reserve(20));
+  CHECK(statistics->load().highWaterMark == 40);
+
+  // Wraps around, skipping the last 4 bytes. The read position was not
+  // reloaded, so the occupancy is not sampled
+  REQUIRE(writer.reserve(25));
+  counters = statistics->load();
+  CHECK(counters.bytesCommitted == 85);
+  CHECK(counters.messagesCommitted == 3);
+  CHECK(counters.wraps == 1);
+  CHECK(counters.wastedBytes == 4);
+  CHECK(counters.highWaterMark == 40);
+
+  // Only 4 bytes are left before the read position. The failure reloads it,
+  // and the next commit samples the tail from the read position to `last`
+  // plus the new head
+  REQUIRE(!writer.reserve(10));
+  REQUIRE(writer.reserve(4));
+  counters = statistics->load();
+  CHECK(counters.reserveFailures == 3);
+  CHECK(counters.highWaterMark == 59);
+
+  REQUIRE(reader.read().size() == 30);
+  REQUIRE(reader.advance(30));
+  REQUIRE(reader.read().size() == 29);
+  REQUIRE(reader.advance(29));
+  counters = statistics->load();
+  CHECK(counters.bytesCommitted == 89);
+  CHECK(counters.bytesConsumed == 89);
+  CHECK(counters.advances == 3);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBufferStatistics high-water mark with a reader that keeps up",
+  "[bipbuffer][statistics]") {
+  constexpr size_t BUFFER_SIZE = 4096;
+  constexpr size_t MESSAGE_SIZE = 64;
+  constexpr uint32_t FLAGS = mvi::BipBufferHeaderV2::FLAG_STATISTICS;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t,
+    sizeof(mvi::BipBufferHeaderV2) + sizeof(mvi::BipBufferStatistics) + BUFFER_SIZE>
+    buffer{};
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size(), FLAGS);
+  REQUIRE(layout != nullptr);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  // Many passes through the buffer, never holding more than one message
+  for (size_t i = 0; i < 1000; ++i) {
+    REQUIRE(writer.reserve(MESSAGE_SIZE));
+    writer.flush();
+    REQUIRE(reader.read().size() == MESSAGE_SIZE);
+    REQUIRE(reader.advance(MESSAGE_SIZE));
+  }
+  const auto counters = layout->statistics()->load();
+  CHECK(counters.wraps == 15);
+  CHECK(counters.reserveFailures == 0);
+  CHECK(counters.highWaterMark == MESSAGE_SIZE);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
@@ -0,0 +1,148 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferWait.hpp"
+#include "BipBufferWriter.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <chrono>
+#include <string_view>
+#include <cstring> // for memcpy
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
+
+TEST_CASE("BipBuffer blocking calls time out", "[bipbuffer][wait]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(
+    buffer.data(), buffer.size(), mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+  REQUIRE(layout != nullptr);
+  REQUIRE(layout->flags == mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  const auto strategy = GENERATE(
+    mvi::WaitStrategy::BusySpin, mvi::WaitStrategy::SpinPause, mvi::WaitStrategy::SpinFutex);
+
+  // Nothing to read
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE(reader.read(strategy, 20ms).empty());
+  REQUIRE(std::chrono::steady_clock::now() - start >= 20ms);
+  REQUIRE(layout->readerWaiting.load(ORDER_STRICT) == 0);
+
+  // No space to write
+  REQUIRE(writer.reserve(32, strategy, 0ms));
+  start = std::chrono::steady_clock::now();
+  REQUIRE(!writer.reserve(1, strategy, 20ms));
+  REQUIRE(std::chrono::steady_clock::now() - start >= 20ms);
+  REQUIRE(layout->writerWaiting.load(ORDER_STRICT) == 0);
+
+  // Available data and space are returned without waiting
+  REQUIRE(reader.read(strategy, 0ms).size() == 32);
+  REQUIRE(reader.advance(32));
+  REQUIRE(writer.reserve(1, strategy, 0ms));
+}
+
+TEST_CASE("BipBuffer sleeping reader is woken by the writer", "[bipbuffer][wait]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(
+    buffer.data(), buffer.size(), mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  std::string_view data;
+  std::thread readerThread([&]() { data = reader.read(mvi::WaitStrategy::SpinFutex, 10s); });
+
+  // Wait until the reader is asleep in the kernel before writing
+  while (layout->readerWaiting.load(ORDER_STRICT) == 0) {
+    std::this_thread::sleep_for(1ms);
+  }
+  auto reservation = writer.reserve(3);
+  REQUIRE(reservation);
+  std::memcpy(reservation.data(), "abc", 3);
+  reservation.commit();
+  readerThread.join();
+  REQUIRE(data == "abc");
+  REQUIRE(layout->readerWaiting.load(ORDER_STRICT) == 0);
+}
+
+TEST_CASE("BipBuffer sleeping writer is woken by the reader", "[bipbuffer][wait]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 32;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(
+    buffer.data(), buffer.size(), mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  REQUIRE(writer.reserve(31));
+  bool reserved = false;
+  std::thread writerThread([&]() {
+    reserved = bool(writer.reserve(8, mvi::WaitStrategy::SpinFutex, 10s));
+  });
+
+  // Wait until the writer is asleep in the kernel before freeing space
+  while (layout->writerWaiting.load(ORDER_STRICT) == 0) {
+    std::this_thread::sleep_for(1ms);
+  }
+  REQUIRE(reader.read().size() == 31);
+  REQUIRE(reader.advance(31));
+  writerThread.join();
+  REQUIRE(reserved);
+  REQUIRE(layout->writerWaiting.load(ORDER_STRICT) == 0);
+}
+
+TEST_CASE("BipBuffer concurrent access with wait strategies", "[bipbuffer][wait][concurrent]") {
+  constexpr size_t BUFFER_SIZE = sizeof(mvi::BipBufferHeaderV2) + 4096;
+  constexpr size_t MESSAGE_COUNT = 20000;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  const auto strategy = GENERATE(
+    mvi::WaitStrategy::BusySpin, mvi::WaitStrategy::SpinPause, mvi::WaitStrategy::SpinFutex);
+  const uint32_t flags = GENERATE(uint32_t(0), mvi::BipBufferHeaderV2::FLAG_WAKEUPS);
+
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size(), flags);
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  auto writerFunc = [&]() {
+    for (size_t i = 0; i < MESSAGE_COUNT; ++i) {
+      auto reservation = writer.reserve(sizeof(i), strategy, 10s);
+      if (!reservation) { return; }
+      std::memcpy(reservation.data(), &i, sizeof(i));
+    }
+  };
+
+  size_t errors = 0;
+  auto readerFunc = [&]() {
+    size_t expected = 0;
+    while (expected < MESSAGE_COUNT) {
+      const auto data = reader.read(strategy, 10s);
+      if (data.empty() || data.size() % sizeof(size_t) != 0) {
+        ++errors;
+        return;
+      }
+      for (size_t j = 0; j < data.size(); j += sizeof(size_t)) {
+        size_t value;
+        std::memcpy(&value, data.data() + j, sizeof(value));
+        if (value != expected++) { ++errors; }
+      }
+      if (!reader.advance(data.size())) { ++errors; }
+    }
+  };
+
+  std::thread writerThread(writerFunc);
+  std::thread readerThread(readerFunc);
+  writerThread.join();
+  readerThread.join();
+
+  REQUIRE(errors == 0);
+}
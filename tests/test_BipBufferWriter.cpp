@@ -3,7 +3,11 @@
 #include <catch2/catch_all.hpp>
 
 #include <array>
+#include <chrono>
 #include <cstring> // for memcpy
+#include <optional>
+#include <thread>
+#include <utility>
 
 constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
 constexpr size_t HEADER_SIZE = sizeof(mvi::BipBufferHeader);
@@ -17,28 +21,30 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
 
   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
 
-  mvi::BipBufferWriter writer{*layout};
+  // The writer caches its own write position, so it is re-created below
+  // whenever the test moves the write position behind its back
+  std::optional<mvi::BipBufferWriter> writer{std::in_place, *layout};
 
   // Can't reserve more than the total buffer size
-  auto reservation = writer.reserve(33);
-  REQUIRE(reservation == nullptr);
+  auto reservation = writer->reserve(33);
+  REQUIRE(!reservation);
 
   // Reserve exactly the max available space
-  reservation = writer.reserve(32);
-  REQUIRE(reservation != nullptr);
-  REQUIRE(reservation->size() == 32);
-  REQUIRE(reservation->data() == buffer.data() + HEADER_SIZE);
+  reservation = writer->reserve(32);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 32);
+  REQUIRE(reservation.data() == buffer.data() + HEADER_SIZE);
 
   // Write some data
   std::array<uint8_t, 3> testData{0x01, 0x02, 0x03};
-  memcpy(reservation->data(), testData.data(), testData.size());
+  memcpy(reservation.data(), testData.data(), testData.size());
 
   // Confirm the bipbuffer header hasn't changed
   REQUIRE(layout->read.load(ORDER_STRICT) == 0);
   REQUIRE(layout->write.load(ORDER_STRICT) == 0);
   REQUIRE(layout->last.load(ORDER_STRICT) == 0);
 
-  reservation.reset(); // Commit the reservation
+  reservation.commit(); // Commit the reservation
 
   // Confirm the bipbuffer header was updated
   REQUIRE(layout->read.load(ORDER_STRICT) == 0);
@@ -53,24 +59,24 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
   }
 
   // Attempt to reserve more data, it will fail since the buffer is full
-  reservation = writer.reserve(1);
-  REQUIRE(reservation == nullptr);
+  reservation = writer->reserve(1);
+  REQUIRE(!reservation);
 
   // Move the read pointer forward one byte
   layout->read.store(1, ORDER_STRICT);
 
-  reservation = writer.reserve(1);
-  REQUIRE(reservation == nullptr);
+  reservation = writer->reserve(1);
+  REQUIRE(!reservation);
 
   // Move the read pointer forward one more byte
   layout->read.store(2, ORDER_STRICT);
 
-  reservation = writer.reserve(1);
-  REQUIRE(reservation != nullptr);
-  REQUIRE(reservation->size() == 1);
-  REQUIRE(reservation->data() == buffer.data() + HEADER_SIZE);
+  reservation = writer->reserve(1);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 1);
+  REQUIRE(reservation.data() == buffer.data() + HEADER_SIZE);
 
-  reservation.reset();
+  reservation.commit();
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 2);
   REQUIRE(layout->write.load(ORDER_STRICT) == 1);
@@ -79,36 +85,38 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
   // Test reservation at a non-zero offset
   layout->write.store(5, ORDER_STRICT);
   layout->read.store(2, ORDER_STRICT);
-  reservation = writer.reserve(3);
-  REQUIRE(reservation != nullptr);
-  REQUIRE(reservation->size() == 3);
-  REQUIRE(reservation->data() == buffer.data() + HEADER_SIZE + 5);
-  reservation.reset();
+  writer.emplace(*layout);
+  reservation = writer->reserve(3);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 3);
+  REQUIRE(reservation.data() == buffer.data() + HEADER_SIZE + 5);
+  reservation.commit();
 
   // Test wrapping reservation
   layout->write.store(28);
   layout->read.store(26);
-  reservation = writer.reserve(5);
-  REQUIRE(reservation != nullptr);
-  REQUIRE(reservation->size() == 5);
-  REQUIRE(reservation->data() == buffer.data() + HEADER_SIZE);
+  writer.emplace(*layout);
+  reservation = writer->reserve(5);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 5);
+  REQUIRE(reservation.data() == buffer.data() + HEADER_SIZE);
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 26);
   REQUIRE(layout->write.load(ORDER_STRICT) == 28);
   REQUIRE(layout->last.load(ORDER_STRICT) == 32);
 
-  reservation.reset();
+  reservation.commit();
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 26);
   REQUIRE(layout->write.load(ORDER_STRICT) == 5);
   REQUIRE(layout->last.load(ORDER_STRICT) == 28);
 
   // Test truncation
-  reservation = writer.reserve(4);
-  REQUIRE(reservation != nullptr);
-  REQUIRE_FALSE(reservation->truncate(5));
-  REQUIRE(reservation->truncate(2));
-  reservation.reset();
+  reservation = writer->reserve(4);
+  REQUIRE(reservation);
+  REQUIRE_FALSE(reservation.truncate(5));
+  REQUIRE(reservation.truncate(2));
+  reservation.commit();
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 26);
   REQUIRE(layout->write.load(ORDER_STRICT) == 7);
@@ -116,11 +124,11 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
 
   // Ensure `last` can be reset to the end of the buffer
   layout->read.store(1, ORDER_STRICT);
-  reservation = writer.reserve(25);
-  REQUIRE(reservation != nullptr);
-  REQUIRE(reservation->size() == 25);
-  REQUIRE(reservation->data() == buffer.data() + HEADER_SIZE + 7);
-  reservation.reset();
+  reservation = writer->reserve(25);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 25);
+  REQUIRE(reservation.data() == buffer.data() + HEADER_SIZE + 7);
+  reservation.commit();
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 1);
   REQUIRE(layout->write.load(ORDER_STRICT) == 32);
@@ -128,9 +136,9 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
 
   // Test cancellation
   layout->read.store(31, ORDER_STRICT);
-  reservation = writer.reserve(10);
-  reservation->cancel();
-  reservation.reset();
+  reservation = writer->reserve(10);
+  reservation.cancel();
+  reservation.commit();
 
   REQUIRE(layout->read.load(ORDER_STRICT) == 31);
   REQUIRE(layout->write.load(ORDER_STRICT) == 32);
@@ -138,3 +146,150 @@ TEST_CASE("BipBufferWriter basic lifecycle", "[bipbuffer]") {
 
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
 }
+
+TEST_CASE("BipBufferWriterReservation move semantics", "[bipbuffer]") {
+  constexpr size_t BUFFER_SIZE = 64;
+  std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == 32);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferWriter writer{*layout};
+
+  // A default-constructed reservation is empty and commits nothing
+  {
+    mvi::BipBufferWriterReservation empty;
+    REQUIRE(!empty);
+    REQUIRE(empty.size() == 0);
+  }
+  REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+
+  // Moving transfers the reservation, which is committed exactly once
+  auto reservation = writer.reserve(4);
+  REQUIRE(reservation);
+  mvi::BipBufferWriterReservation moved{std::move(reservation)};
+  REQUIRE(!reservation); // NOLINT(bugprone-use-after-move)
+  REQUIRE(moved);
+  REQUIRE(moved.size() == 4);
+  REQUIRE(moved.data() == buffer.data() + HEADER_SIZE);
+  reservation.commit(); // NOLINT(bugprone-use-after-move)
+  REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+  moved.commit();
+  REQUIRE(!moved);
+  REQUIRE(layout->write.load(ORDER_STRICT) == 4);
+  moved.commit();
+  REQUIRE(layout->write.load(ORDER_STRICT) == 4);
+
+  // Move-assigning over a held reservation commits it first
+  reservation = writer.reserve(2);
+  REQUIRE(reservation);
+  reservation = mvi::BipBufferWriterReservation{};
+  REQUIRE(!reservation);
+  REQUIRE(layout->write.load(ORDER_STRICT) == 6);
+
+  // Destruction commits
+  {
+    auto scoped = writer.reserve(3);
+    REQUIRE(scoped);
+  }
+  REQUIRE(layout->write.load(ORDER_STRICT) == 9);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipBufferWriter batched publishing", "[bipbuffer]") {
+  constexpr size_t BUFFER_SIZE = 64;
+  std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == 32);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferWriter writer{*layout};
+  auto commit = [&writer](size_t length) {
+    auto reservation = writer.reserve(length);
+    REQUIRE(reservation);
+    reservation.commit();
+  };
+
+  SECTION("Message count limit") {
+    writer.setBatchPolicy({3, 0, std::chrono::nanoseconds::zero()});
+    commit(1);
+    commit(1);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    REQUIRE(layout->last.load(ORDER_STRICT) == 0);
+    commit(1);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 3);
+    REQUIRE(layout->last.load(ORDER_STRICT) == 3);
+  }
+
+  SECTION("Byte limit") {
+    writer.setBatchPolicy({0, 8, std::chrono::nanoseconds::zero()});
+    commit(4);
+    commit(3);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    commit(1);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 8);
+  }
+
+  SECTION("Latency limit") {
+    writer.setBatchPolicy({0, 0, std::chrono::milliseconds(1)});
+    commit(2);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    // The latency limit is enforced on the next reservation
+    auto reservation = writer.reserve(1);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 2);
+    reservation.cancel();
+  }
+
+  SECTION("Explicit flush") {
+    writer.setBatchPolicy({0, 0, std::chrono::nanoseconds::zero()});
+    commit(5);
+    commit(5);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    writer.flush();
+    REQUIRE(layout->write.load(ORDER_STRICT) == 10);
+    REQUIRE(layout->last.load(ORDER_STRICT) == 10);
+
+    // Changing the policy publishes the pending batch
+    commit(1);
+    writer.setBatchPolicy({1, 0, std::chrono::nanoseconds::zero()});
+    REQUIRE(layout->write.load(ORDER_STRICT) == 11);
+  }
+
+  SECTION("Wraparound within a batch") {
+    writer.setBatchPolicy({0, 0, std::chrono::nanoseconds::zero()});
+    commit(30);
+    writer.flush();
+    layout->read.store(30, ORDER_STRICT);
+    commit(2);
+    commit(4); // Wraps to the start of the buffer
+    REQUIRE(layout->write.load(ORDER_STRICT) == 30);
+    writer.flush();
+    REQUIRE(layout->write.load(ORDER_STRICT) == 4);
+    REQUIRE(layout->last.load(ORDER_STRICT) == 32);
+  }
+
+  SECTION("Running out of space publishes the batch") {
+    writer.setBatchPolicy({0, 0, std::chrono::nanoseconds::zero()});
+    commit(32);
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    REQUIRE(!writer.reserve(1));
+    REQUIRE(layout->write.load(ORDER_STRICT) == 32);
+  }
+
+  SECTION("Destruction publishes the batch") {
+    std::optional<mvi::BipBufferWriter> batched{std::in_place, *layout};
+    batched->setBatchPolicy({0, 0, std::chrono::nanoseconds::zero()});
+    batched->reserve(6).commit();
+    REQUIRE(layout->write.load(ORDER_STRICT) == 0);
+    batched.reset();
+    REQUIRE(layout->write.load(ORDER_STRICT) == 6);
+  }
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
@@ -3,16 +3,22 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <string_view>
 #include <thread>
 #include <vector>
 
-TEST_CASE("BipBuffer concurrent access", "[bipbuffer][concurrent]") {
-  constexpr size_t BUFFER_SIZE = 128;
-  std::array<uint8_t, BUFFER_SIZE> buffer{};
+TEMPLATE_TEST_CASE("BipBuffer concurrent access",
+  "[bipbuffer][concurrent]",
+  mvi::BipBufferHeader,
+  mvi::BipBufferHeaderV2) {
+  constexpr size_t BUFFER_SIZE = sizeof(TestType) + 96;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
 
-  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
-  REQUIRE(layout->bufferSize == BUFFER_SIZE - sizeof(mvi::BipBufferHeader));
+  auto layout = TestType::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == BUFFER_SIZE - sizeof(TestType));
 
   mvi::BipBufferWriter writer{*layout};
   mvi::BipBufferReader reader{*layout};
@@ -31,8 +37,8 @@ TEST_CASE("BipBuffer concurrent access", "[bipbuffer][concurrent]") {
         std::this_thread::yield(); // Yield thread if reservation failed, then try again
         reservation = writer.reserve(32);
       }
-      std::memcpy(reservation->data(), testData.data() + offset, 32);
-      reservation.reset(); // Automatically commits the data
+      std::memcpy(reservation.data(), testData.data() + offset, 32);
+      reservation.commit(); // Commits the data
     }
   };
 
@@ -61,3 +67,88 @@ TEST_CASE("BipBuffer concurrent access", "[bipbuffer][concurrent]") {
   writerThread.join();
   readerThread.join();
 }
+
+TEMPLATE_TEST_CASE("BipBuffer stress with variable message sizes",
+  "[bipbuffer][concurrent][stress]",
+  mvi::BipBufferHeader,
+  mvi::BipBufferHeaderV2) {
+  // A small buffer relative to the message sizes forces frequent wraparounds, partially consumed
+  // reads, and a `last` marker that moves around the end of the buffer
+  constexpr size_t BUFFER_SIZE = sizeof(TestType) + 61;
+  constexpr size_t MAX_MESSAGE_SIZE = 24;
+  constexpr size_t TOTAL_BYTES = 1024 * 1024;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = TestType::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  mvi::BipBufferWriter writer{*layout};
+  mvi::BipBufferReader reader{*layout};
+
+  // Run both with every commit published immediately and with batched publishing
+  const size_t batchMessages = GENERATE(size_t(1), size_t(4));
+  writer.setBatchPolicy({batchMessages, 0, std::chrono::nanoseconds::zero()});
+
+  // The byte at stream position `i` is derived from `i`, so the reader can validate the stream
+  // without sharing any state with the writer
+  auto expected = [](size_t i) { return static_cast<uint8_t>((i * 7) ^ (i >> 8)); };
+
+  auto writerFunc = [&]() {
+    size_t position = 0;
+    size_t messageSize = 1;
+    while (position < TOTAL_BYTES) {
+      // Reserve an upper bound and truncate to the actual size, as a sender with a
+      // variable-length encoding would
+      const size_t length = std::min(messageSize, TOTAL_BYTES - position);
+      auto reservation = writer.reserve(MAX_MESSAGE_SIZE);
+      while (!reservation) {
+        std::this_thread::yield();
+        reservation = writer.reserve(MAX_MESSAGE_SIZE);
+      }
+      for (size_t i = 0; i < length; ++i) {
+        reservation.data()[i] = expected(position + i);
+      }
+      (void)reservation.truncate(length);
+      reservation.commit();
+      position += length;
+      messageSize = messageSize % MAX_MESSAGE_SIZE + 1;
+    }
+    writer.flush();
+  };
+
+  size_t mismatches = 0;
+  auto readerFunc = [&]() {
+    size_t position = 0;
+    size_t chunk = 1;
+    while (position < TOTAL_BYTES) {
+      // Alternate between reading one segment and both segments across the wraparound
+      std::array<std::string_view, 2> spans{};
+      if (chunk % 2 == 0) {
+        spans = reader.readAll();
+      } else {
+        spans[0] = reader.read();
+      }
+      if (spans[0].empty() && spans[1].empty()) {
+        std::this_thread::yield();
+        continue;
+      }
+      // Consume only part of what is available to exercise partial advances
+      const size_t count = std::min(chunk, spans[0].size() + spans[1].size());
+      for (size_t i = 0; i < count; ++i) {
+        const char byte = i < spans[0].size() ? spans[0][i] : spans[1][i - spans[0].size()];
+        if (static_cast<uint8_t>(byte) != expected(position + i)) { ++mismatches; }
+      }
+      if (!reader.advance(count)) { ++mismatches; }
+      position += count;
+      chunk = chunk % (MAX_MESSAGE_SIZE * 2) + 1;
+    }
+  };
+
+  std::thread writerThread(writerFunc);
+  std::thread readerThread(readerFunc);
+  writerThread.join();
+  readerThread.join();
+
+  REQUIRE(mismatches == 0);
+  REQUIRE(reader.read().empty());
+}
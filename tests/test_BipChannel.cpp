@@ -0,0 +1,158 @@
+#include "BipBufferReader.hpp"
+#include "BipBufferWriter.hpp"
+#include "BipChannel.hpp"
+#include "helpers.hpp"
+#include "requires.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/wait.h> // ::waitpid()
+#include <unistd.h> // ::fork(), ::_exit()
+#endif
+
+TEST_CASE("BipChannel create and attach", "[bipbuffer][channel][shm]") {
+  constexpr const char* NAME = "testchannel";
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipChannel consumer(NAME);
+  auto err = consumer.attach();
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::timed_out);
+  CHECK(consumer.header() == nullptr);
+
+  mvi::BipChannel producer(NAME);
+  REQUIRE(producer.create(0));
+  REQUIRE_NO_ERROR(producer.create(100));
+  REQUIRE(producer.header() != nullptr);
+  CHECK(producer.header()->bufferSize >= 100);
+  CHECK(producer.producerAlive());
+  CHECK(!producer.consumerAlive());
+
+  // The consumer only needs the name
+  REQUIRE_NO_ERROR(consumer.attach());
+  REQUIRE(consumer.header() != nullptr);
+  CHECK(consumer.header()->bufferSize == producer.header()->bufferSize);
+  CHECK(consumer.producerAlive());
+  CHECK(producer.consumerAlive());
+
+  mvi::BipBufferWriter writer{*producer.header()};
+  mvi::BipBufferReader reader{*consumer.header()};
+  REQUIRE(Write(writer, "hello"));
+  CHECK(reader.read() == "hello");
+
+  // The consumer and the producer slots are taken
+  mvi::BipChannel second(NAME);
+  err = second.attach();
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::device_or_resource_busy);
+  err = second.create(100);
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::device_or_resource_busy);
+
+  // Closing frees the slot for the next consumer
+  REQUIRE_NO_ERROR(consumer.close());
+  CHECK(!producer.consumerAlive());
+  REQUIRE_NO_ERROR(second.attach());
+  CHECK(producer.consumerAlive());
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE_NO_ERROR(second.close());
+  REQUIRE_NO_ERROR(producer.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("BipChannel rejects foreign areas", "[bipbuffer][channel][shm]") {
+  constexpr const char* NAME = "testchannelforeign";
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipChannel producer(NAME);
+  REQUIRE_NO_ERROR(producer.create(100));
+  auto* control = const_cast<mvi::BipChannel::Control*>(producer.control());
+
+  mvi::BipChannel consumer(NAME);
+  control->version = mvi::BipChannel::Control::VERSION + 1;
+  auto err = consumer.attach();
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::protocol_error);
+
+  control->version = mvi::BipChannel::Control::VERSION;
+  producer.header()->magic = 0;
+  err = consumer.attach();
+  REQUIRE(err);
+  CHECK(err->code() == std::errc::protocol_error);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE_NO_ERROR(producer.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("BipChannel consumer waits for the producer", "[bipbuffer][channel][shm]") {
+  constexpr const char* NAME = "testchannelwait";
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // The consumer starts first and attaches once the channel is ready
+  std::optional<std::system_error> attachError;
+  mvi::BipChannel consumer(NAME);
+  std::thread thread([&] { attachError = consumer.attach(std::chrono::seconds(10)); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  mvi::BipChannel producer(NAME);
+  REQUIRE_NO_ERROR(producer.create(1000));
+  thread.join();
+  REQUIRE_NO_ERROR(attachError);
+  REQUIRE(consumer.header() != nullptr);
+  CHECK(producer.consumerAlive());
+
+  REQUIRE_NO_ERROR(consumer.close());
+  REQUIRE_NO_ERROR(producer.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+#ifndef _WIN32
+TEST_CASE("BipChannel detects exited peers", "[bipbuffer][channel][shm]") {
+  constexpr const char* NAME = "testchannelpeer";
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  mvi::BipChannel producer(NAME);
+  REQUIRE_NO_ERROR(producer.create(1000));
+
+  // A consumer process exits without closing the channel
+  const pid_t child = ::fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    mvi::BipChannel consumer(NAME);
+    ::_exit(consumer.attach() ? 1 : 0);
+  }
+  int status = 0;
+  REQUIRE(::waitpid(child, &status, 0) == child);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+  CHECK(producer.control()->consumerPid.load() == uint32_t(child));
+  CHECK(!producer.consumerAlive());
+
+  // The next consumer takes over its slot
+  mvi::BipChannel consumer(NAME);
+  REQUIRE_NO_ERROR(consumer.attach());
+  CHECK(producer.consumerAlive());
+
+  // After the producer closes, a new producer replaces the channel
+  REQUIRE_NO_ERROR(producer.close());
+  CHECK(!consumer.producerAlive());
+  mvi::BipChannel restarted(NAME);
+  REQUIRE_NO_ERROR(restarted.create(1000));
+  CHECK(!restarted.consumerAlive());
+
+  REQUIRE_NO_ERROR(consumer.close());
+  REQUIRE_NO_ERROR(restarted.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+#endif // _WIN32
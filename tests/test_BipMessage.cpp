@@ -0,0 +1,160 @@
+#include "BipMessageFrame.hpp"
+#include "BipMessageReader.hpp"
+#include "BipMessageWriter.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstring> // for memcpy
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr auto ORDER_STRICT = std::memory_order_seq_cst;
+
+static std::vector<std::string> ReadAll(mvi::BipMessageReader& reader) {
+  std::vector<std::string> messages;
+  const auto batch = reader.read();
+  for (const std::string_view message : batch) {
+    messages.emplace_back(message);
+  }
+  REQUIRE(reader.release(batch));
+  return messages;
+}
+
+TEST_CASE("BipMessage basic lifecycle", "[bipbuffer][message]") {
+  constexpr size_t BUFFER_SIZE = 64;
+  std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeader::Create(buffer.data(), buffer.size());
+  REQUIRE(layout->bufferSize == 32);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::BipBufferWriter bufferWriter{*layout};
+  mvi::BipBufferReader bufferReader{*layout};
+  mvi::BipMessageWriter writer{bufferWriter};
+  mvi::BipMessageReader reader{bufferReader};
+
+  // Nothing to read
+  auto batch = reader.read();
+  REQUIRE(batch.empty());
+  REQUIRE(batch.begin() == batch.end());
+
+  // The payload and frame header must fit in the buffer
+  REQUIRE(!writer.reserve(32 - mvi::BIP_MESSAGE_HEADER_SIZE + 1));
+
+  // Write several messages, including an empty one, and read them back as one batch
+  REQUIRE(writer.write("hello", 5));
+  REQUIRE(writer.write("", 0));
+  REQUIRE(writer.write("world", 5));
+  batch = reader.read();
+  REQUIRE(batch.size() == 3 * mvi::BIP_MESSAGE_HEADER_SIZE + 10);
+  std::vector<std::string> messages;
+  for (const std::string_view message : batch) {
+    messages.emplace_back(message);
+  }
+  REQUIRE(messages == std::vector<std::string>{"hello", "", "world"});
+
+  // Released with a single advance
+  REQUIRE(reader.release(batch));
+  REQUIRE(layout->read.load(ORDER_STRICT) == batch.size());
+  REQUIRE(reader.read().empty());
+
+  // Reserve an upper bound and truncate it to the actual length
+  auto reservation = writer.reserve(8);
+  REQUIRE(reservation);
+  REQUIRE(reservation.size() == 8);
+  std::memcpy(reservation.data(), "abc", 3);
+  REQUIRE_FALSE(reservation.truncate(9));
+  REQUIRE(reservation.truncate(3));
+  REQUIRE(reservation.size() == 3);
+  reservation.commit();
+  REQUIRE(!reservation);
+
+  // The truncated message wrapped around to the start of the buffer
+  REQUIRE(ReadAll(reader) == std::vector<std::string>{"abc"});
+  REQUIRE(layout->read.load(ORDER_STRICT) == mvi::BIP_MESSAGE_HEADER_SIZE + 3);
+
+  // Canceled messages are not written at all
+  reservation = writer.reserve(4);
+  REQUIRE(reservation);
+  reservation.cancel();
+  reservation.commit();
+  REQUIRE(reader.read().empty());
+
+  REQUIRE(writer.write("0123456789ab", 12));
+  REQUIRE(ReadAll(reader) == std::vector<std::string>{"0123456789ab"});
+  REQUIRE(layout->read.load(ORDER_STRICT) == 23);
+
+  // The second message does not fit before the end of the buffer and wraps
+  // around, so the batch spans both segments
+  REQUIRE(writer.write("xy", 2));
+  REQUIRE(writer.write("uvwxyz", 6));
+  REQUIRE(layout->last.load(ORDER_STRICT) == 29);
+  REQUIRE(layout->write.load(ORDER_STRICT) == 10);
+  REQUIRE(ReadAll(reader) == std::vector<std::string>{"xy", "uvwxyz"});
+  REQUIRE(layout->read.load(ORDER_STRICT) == 10);
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("BipMessage concurrent access", "[bipbuffer][message][concurrent]") {
+  constexpr size_t BUFFER_SIZE = 1024;
+  constexpr size_t MESSAGE_COUNT = 100000;
+  alignas(mvi::CACHE_LINE_SIZE) std::array<uint8_t, BUFFER_SIZE> buffer{};
+
+  auto layout = mvi::BipBufferHeaderV2::Create(buffer.data(), buffer.size());
+  REQUIRE(layout != nullptr);
+
+  mvi::BipBufferWriter bufferWriter{*layout};
+  mvi::BipBufferReader bufferReader{*layout};
+  mvi::BipMessageWriter writer{bufferWriter};
+  mvi::BipMessageReader reader{bufferReader};
+
+  // Each message holds its sequence number, repeated up to a variable length
+  auto writerFunc = [&]() {
+    for (size_t i = 0; i < MESSAGE_COUNT; ++i) {
+      const size_t count = i % 7;
+      auto reservation = writer.reserve(sizeof(size_t) * 6);
+      while (!reservation) {
+        std::this_thread::yield();
+        reservation = writer.reserve(sizeof(size_t) * 6);
+      }
+      for (size_t j = 0; j < count; ++j) {
+        std::memcpy(reservation.data() + j * sizeof(size_t), &i, sizeof(size_t));
+      }
+      (void)reservation.truncate(count * sizeof(size_t));
+    }
+  };
+
+  size_t errors = 0;
+  auto readerFunc = [&]() {
+    size_t expected = 0;
+    while (expected < MESSAGE_COUNT) {
+      const auto batch = reader.read();
+      if (batch.empty()) {
+        std::this_thread::yield();
+        continue;
+      }
+      for (const std::string_view message : batch) {
+        if (message.size() != (expected % 7) * sizeof(size_t)) { ++errors; }
+        for (size_t j = 0; j + sizeof(size_t) <= message.size(); j += sizeof(size_t)) {
+          size_t value;
+          std::memcpy(&value, message.data() + j, sizeof(size_t));
+          if (value != expected) { ++errors; }
+        }
+        ++expected;
+      }
+      if (!reader.release(batch)) { ++errors; }
+    }
+  };
+
+  std::thread writerThread(writerFunc);
+  std::thread readerThread(readerFunc);
+  writerThread.join();
+  readerThread.join();
+
+  REQUIRE(errors == 0);
+  REQUIRE(reader.read().empty());
+}
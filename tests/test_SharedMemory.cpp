@@ -7,6 +7,9 @@
 
 #ifdef _WIN32
 #include <winerror.h>
+#else
+#include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 using Access = mvi::SharedMemory::Access;
@@ -240,3 +243,227 @@ TEST_CASE("SharedMemory persistence", "[shm]") {
   err = mvi::SharedMemory::Destroy(NAME);
   REQUIRE_NO_ERROR(err);
 }
+
+TEST_CASE("SharedMemory mirrored mapping", "[shm]") {
+  constexpr const char* NAME = "mirror";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+  const size_t size = 3 * pageSize;
+  const mvi::SharedMemory::Options options{true, pageSize};
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+#ifdef _WIN32
+  mvi::SharedMemory shm(NAME, size);
+  auto err = shm.open(Access::ReadWrite, options);
+  REQUIRE(err);
+  REQUIRE(err->code().value() == ERROR_NOT_SUPPORTED);
+#else
+  // The size and the mirror offset must be page multiples
+  mvi::SharedMemory unaligned(NAME, size + 1);
+  auto err = unaligned.open(Access::ReadWrite, options);
+  REQUIRE(err);
+  REQUIRE(err->code().value() == EINVAL);
+  err = unaligned.open(Access::ReadWrite, mvi::SharedMemory::Options{true, size});
+  REQUIRE(err);
+
+  mvi::SharedMemory shmWriter(NAME, size);
+  mvi::SharedMemory shmReader(NAME, size);
+  REQUIRE_NO_ERROR(shmWriter.open(Access::ReadWrite, options));
+  REQUIRE_NO_ERROR(shmReader.open(Access::ReadOnly, options));
+
+  // Writes past the end of the area land at the mirror offset, in both mappings
+  char* writer = shmWriter.as<char>();
+  const char* reader = shmReader.as<char>();
+  writer[size] = 'A';
+  writer[2 * size - pageSize - 1] = 'B';
+  writer[0] = 'C';
+  CHECK(writer[pageSize] == 'A');
+  CHECK(reader[pageSize] == 'A');
+  CHECK(reader[size] == 'A');
+  CHECK(reader[size - 1] == 'B');
+  CHECK(reader[0] == 'C');
+
+  REQUIRE_NO_ERROR(shmWriter.close());
+  REQUIRE_NO_ERROR(shmReader.close());
+#endif
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("SharedMemory capacity is page rounded", "[shm]") {
+  constexpr const char* NAME = "rounded";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  mvi::SharedMemory shmWriter(NAME, pageSize + 1);
+  REQUIRE_NO_ERROR(shmWriter.open(Access::ReadWrite));
+  CHECK(shmWriter.capacity() == 2 * pageSize);
+
+  // The whole capacity is shared, also with mappings that asked for less
+  mvi::SharedMemory shmReader(NAME, 1);
+  REQUIRE_NO_ERROR(shmReader.open(Access::ReadOnly));
+  CHECK(shmReader.capacity() == 2 * pageSize);
+  shmWriter.as<char>()[2 * pageSize - 1] = 'Z';
+  CHECK(shmReader.as<char>()[2 * pageSize - 1] == 'Z');
+
+  REQUIRE_NO_ERROR(shmReader.close());
+  REQUIRE_NO_ERROR(shmWriter.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("SharedMemory prefault, lock and huge page options", "[shm]") {
+  constexpr const char* NAME = "options";
+  constexpr size_t SIZE = 3 * 1024 * 1024;
+  const size_t hugePageSize = mvi::SharedMemory::HugePageSize();
+  REQUIRE(hugePageSize >= mvi::SharedMemory::PageSize());
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  mvi::SharedMemory::Options options;
+  options.prefault = true;
+  options.hugePages = true;
+  mvi::SharedMemory shm(NAME, SIZE);
+  REQUIRE_NO_ERROR(shm.open(Access::ReadWrite, options));
+  CHECK(shm.capacity() >= SIZE);
+#ifndef _WIN32
+  // Huge pages are ignored on Windows
+  CHECK(shm.capacity() % hugePageSize == 0);
+  // The mapping is aligned so that huge pages can back it
+  CHECK(reinterpret_cast<uintptr_t>(shm.as<char>()) % hugePageSize == 0);
+#endif
+  shm.as<char>()[SIZE - 1] = 'A';
+  REQUIRE_NO_ERROR(shm.close());
+
+  // Locking may exceed the memory lock limit of an unprivileged process, in
+  // which case the area is not left open
+  options = {};
+  options.lock = true;
+  mvi::SharedMemory locked(NAME, SIZE);
+  auto err = locked.open(Access::ReadOnly, options);
+  if (err) {
+    CHECK(locked.as<char>() == nullptr);
+  } else {
+    CHECK(locked.as<char>()[SIZE - 1] == 'A');
+    REQUIRE_NO_ERROR(locked.close());
+  }
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("SharedMemory anonymous areas and descriptor passing", "[shm]") {
+  constexpr size_t SIZE = 1024;
+
+  mvi::SharedMemory creator = mvi::SharedMemory::Anonymous(SIZE);
+  CHECK(creator.name().empty());
+  CHECK(creator.fd() == -1);
+
+#ifdef _WIN32
+  REQUIRE(creator.open(Access::ReadWrite));
+#else
+  // Peers attach through the descriptor, never by opening the area themselves
+  REQUIRE(creator.open(Access::ReadOnly));
+  REQUIRE_NO_ERROR(creator.open(Access::ReadWrite));
+  REQUIRE(creator.fd() >= 0);
+  CHECK(creator.capacity() >= SIZE);
+
+  std::array<int, 2> sockets{};
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()) == 0);
+  REQUIRE_NO_ERROR(creator.send(sockets[0]));
+  REQUIRE_NO_ERROR(creator.send(sockets[0]));
+
+  // The receiver takes the size of the area from the descriptor
+  mvi::SharedMemory peer = mvi::SharedMemory::Anonymous(0);
+  REQUIRE_NO_ERROR(peer.receive(sockets[1], Access::ReadOnly));
+  CHECK(peer.size() == creator.capacity());
+  CHECK(peer.capacity() == creator.capacity());
+  creator.as<char>()[SIZE - 1] = 'A';
+  CHECK(peer.as<char>()[SIZE - 1] == 'A');
+
+  // A receiver expecting more than the area holds is rejected
+  mvi::SharedMemory tooLarge = mvi::SharedMemory::Anonymous(creator.capacity() + 1);
+  REQUIRE(tooLarge.receive(sockets[1], Access::ReadOnly));
+  CHECK(tooLarge.fd() == -1);
+
+#ifdef __linux__
+  // The memfd is sealed against shrinking under the peer's mapping
+  CHECK(::ftruncate(peer.fd(), 0) == -1);
+#endif
+
+  // The area stays valid until the last process closes it
+  REQUIRE_NO_ERROR(creator.close());
+  CHECK(peer.as<char>()[SIZE - 1] == 'A');
+  REQUIRE_NO_ERROR(peer.close());
+
+  ::close(sockets[0]);
+  ::close(sockets[1]);
+#endif
+}
+
+TEST_CASE("SharedMemory resize within reserved address space", "[shm]") {
+  constexpr const char* NAME = "resize";
+  const size_t pageSize = mvi::SharedMemory::PageSize();
+
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  mvi::SharedMemory::Options options;
+  options.reserve = 4 * pageSize;
+  mvi::SharedMemory owner(NAME, pageSize);
+  mvi::SharedMemory peer(NAME, pageSize);
+
+#ifdef _WIN32
+  REQUIRE_NO_ERROR(owner.open(Access::ReadWrite, options));
+  REQUIRE(owner.resize(2 * pageSize));
+#else
+  REQUIRE_NO_ERROR(owner.open(Access::ReadWrite, options));
+  REQUIRE_NO_ERROR(peer.open(Access::ReadOnly, options));
+  char* const base = owner.as<char>();
+
+  // The peer can only follow once the owner has grown the object
+  REQUIRE(peer.resize(2 * pageSize));
+  REQUIRE_NO_ERROR(owner.resize(2 * pageSize + 1));
+  CHECK(owner.size() == 2 * pageSize + 1);
+  CHECK(owner.capacity() == 3 * pageSize);
+  CHECK(owner.as<char>() == base);
+  owner.as<char>()[3 * pageSize - 1] = 'G';
+
+  REQUIRE_NO_ERROR(peer.resize(3 * pageSize));
+  CHECK(peer.as<char>()[3 * pageSize - 1] == 'G');
+
+  // Growing past the reservation fails and leaves the mapping intact
+  REQUIRE(owner.resize(4 * pageSize + 1));
+  CHECK(owner.capacity() == 3 * pageSize);
+  CHECK(owner.as<char>()[3 * pageSize - 1] == 'G');
+
+  REQUIRE_NO_ERROR(peer.close());
+#endif
+
+  REQUIRE_NO_ERROR(owner.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}
+
+TEST_CASE("SharedMemory open without a size", "[shm]") {
+  constexpr const char* NAME = "testunsized";
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+
+  // Nothing is created without a size
+  mvi::SharedMemory missing(NAME, 0);
+  REQUIRE(missing.open(mvi::SharedMemory::Access::ReadWrite));
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+  mvi::SharedMemory owner(NAME, 100);
+  REQUIRE_NO_ERROR(owner.open(mvi::SharedMemory::Access::ReadWrite));
+  owner.as<char>()[99] = 'x';
+
+  mvi::SharedMemory peer(NAME, 0);
+  REQUIRE_NO_ERROR(peer.open(mvi::SharedMemory::Access::ReadOnly));
+  CHECK(peer.size() == owner.capacity());
+  CHECK(peer.as<char>()[99] == 'x');
+
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+  REQUIRE_NO_ERROR(peer.close());
+  REQUIRE_NO_ERROR(owner.close());
+  REQUIRE_NO_ERROR(mvi::SharedMemory::Destroy(NAME));
+}